@@ -28,6 +28,7 @@
 #include "common/util.h"
 
 #include "audio/audiostream.h"
+#include "audio/predecode.h"
 #include "audio/decoders/asf.h"
 #include "audio/decoders/wma.h"
 #include "audio/decoders/wave_types.h"
@@ -462,7 +463,7 @@ SeekableAudioStream *makeASFStream(
 		return 0;
 	}
 
-	return s;
+	return makePreDecodingStreamIfEnabled(s);
 }
 
 } // End of namespace Audio
@@ -33,6 +33,7 @@
 #include "common/util.h"
 
 #include "audio/audiostream.h"
+#include "audio/predecode.h"
 
 #define FLAC__NO_DLL // that MS-magic gave me headaches - just link the library you like
 #include <FLAC/export.h>
@@ -732,7 +733,7 @@ SeekableAudioStream *makeFLACStream(
 		delete s;
 		return 0;
 	} else {
-		return s;
+		return makePreDecodingStreamIfEnabled(s);
 	}
 }
 
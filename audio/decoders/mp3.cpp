@@ -34,6 +34,7 @@
 #include "common/util.h"
 
 #include "audio/audiostream.h"
+#include "audio/predecode.h"
 
 #include <mad.h>
 
@@ -546,7 +547,7 @@ SeekableAudioStream *makeMP3Stream(
 		delete s;
 		return 0;
 	} else {
-		return s;
+		return makePreDecodingStreamIfEnabled(s);
 	}
 }
 
@@ -22,6 +22,8 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/array.h"
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -33,6 +35,19 @@
 
 namespace Audio {
 
+// Set while the current thread runs MixerImpl::mixCallback(). Mixer calls
+// made by streams or MIDI drivers from inside the callback then act as the
+// audio side instead of waiting for it.
+#if defined(USE_CXX11)
+static thread_local bool s_inMixCallback = false;
+#elif defined(__GNUC__)
+static __thread bool s_inMixCallback = false;
+#elif defined(_MSC_VER)
+static __declspec(thread) bool s_inMixCallback = false;
+#else
+static bool s_inMixCallback = false;
+#endif
+
 #pragma mark -
 #pragma mark --- Channel classes ---
 #pragma mark -
@@ -40,10 +55,15 @@ namespace Audio {
 
 /**
  * Channel used by the default Mixer implementation.
+ *
+ * A channel is shared between the engine side and the audio thread: the
+ * volume and balance settings belong to the engine side, while mixing,
+ * pausing and the timing information are handled by the audio thread.
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+	        RateConverterQuality quality, SincFilterBankCache *filterBanks);
 	~Channel();
 
 	/**
@@ -59,8 +79,21 @@ public:
 
 	/**
 	 * Queries whether the channel is still playing or not.
+	 * Only to be called from the audio thread.
+	 */
+	bool isFinished() const { return _stream->endOfStream() && _drained; }
+
+	/**
+	 * Marks the channel as finished, after the audio thread stopped
+	 * mixing it.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	void markFinished() { _finished.store(1); }
+
+	/**
+	 * Queries whether the audio thread stopped mixing the channel, because
+	 * its stream ended or because it was stopped.
+	 */
+	bool hasFinished() const { return _finished.load() != 0; }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -76,17 +109,34 @@ public:
 
 	/**
 	 * Pauses or unpaused the channel in a recursive fashion.
+	 * Only to be called from the audio thread.
 	 *
 	 * @param paused true, when the channel should be paused.
 	 *               false when it should be unpaused.
+	 * @param time   the time of the request, in milliseconds
 	 */
-	void pause(bool paused);
+	void pause(bool paused, uint32 time);
 
 	/**
 	 * Queries whether the channel is currently paused.
 	 */
 	bool isPaused() const { return (_pauseLevel != 0); }
 
+	/**
+	 * Requests a pause or unpause from the engine side. It takes effect
+	 * once the audio thread calls applyPause().
+	 *
+	 * @return true if the audio thread has to be notified, false if the
+	 *         request changed nothing or an earlier one is still pending
+	 */
+	bool requestPause(bool paused, uint32 time);
+
+	/**
+	 * Applies the pause level last requested.
+	 * Only to be called from the audio thread.
+	 */
+	void applyPause();
+
 	/**
 	 * Sets the channel's own volume.
 	 *
@@ -116,10 +166,32 @@ public:
 	int8 getBalance();
 
 	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
+	 * Computes the effective left and right volume from the channel
+	 * volume, balance and the global sound type settings.
 	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
+	void getMixVolumes(uint16 &volL, uint16 &volR) const;
+
+	/**
+	 * Sets the effective left and right volume used for mixing.
+	 * Only to be called from the audio thread, or before the channel has
+	 * been handed over to it.
+	 */
+	void setMixVolumes(uint16 volL, uint16 volR) { _volL = volL; _volR = volR; }
+
+	/**
+	 * Requests new effective volumes from the engine side. They take
+	 * effect once the audio thread calls applyMixVolumes().
+	 *
+	 * @return true if the audio thread has to be notified, false if an
+	 *         earlier request is still pending
+	 */
+	bool requestMixVolumes(uint16 volL, uint16 volR);
+
+	/**
+	 * Applies the effective volumes last requested.
+	 * Only to be called from the audio thread.
+	 */
+	void applyMixVolumes();
 
 	/**
 	 * Queries how long the channel has been playing.
@@ -153,7 +225,6 @@ private:
 	byte _volume;
 	int8 _balance;
 
-	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
 	Mixer *_mixer;
@@ -164,38 +235,250 @@ private:
 	uint32 _pauseStartTime;
 	uint32 _pauseTime;
 
+	/**
+	 * Sequence counter protecting the timing information above, which is
+	 * written by the audio thread and read by getElapsedTime(). It is odd
+	 * while an update is in progress.
+	 */
+	Common::Atomic<uint32> _timingSeq;
+	Common::Atomic<int32> _finished;
+
+	/** Settings requested by the engine side, volumes as (volL << 16) | volR */
+	Common::Atomic<uint32> _requestedVolumes;
+	Common::Atomic<int32> _requestedPauseLevel;
+	Common::Atomic<uint32> _pauseRequestTime;
+
+	/** Set while an update of the volumes or the pause level is pending */
+	Common::Atomic<int32> _volumeUpdatePending;
+	Common::Atomic<int32> _pauseUpdatePending;
+
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
+
+	/** Whether the converter output everything after the end of the stream. Only used by the audio thread. */
+	bool _drained;
 };
 
 #pragma mark -
 #pragma mark --- Mixer ---
 #pragma mark -
 
+/**
+ * Return the rate conversion quality selected by the user.
+ */
+static RateConverterQuality getRateConverterQuality() {
+	if (!ConfMan.hasKey("resampling_quality"))
+		return kRateConverterLinear;
+
+	const Common::String &quality = ConfMan.get("resampling_quality");
+	if (quality.equalsIgnoreCase("high"))
+		return kRateConverterSincHigh;
+	else if (quality.equalsIgnoreCase("medium"))
+		return kRateConverterSincMedium;
+	else
+		return kRateConverterLinear;
+}
+
 MixerImpl::MixerImpl(uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _commands(COMMAND_QUEUE_SIZE), _callbackState(0), _callbackStalled(false), _stalledState(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_mixChannels[i] = 0;
+	}
+
+	// Avoid allocating from mixCallback() in the common case
+	_removedChannels.reserve(NUM_CHANNELS);
 }
 
 MixerImpl::~MixerImpl() {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+	for (uint i = 0; i < _stoppedChannels.size(); i++)
+		delete _stoppedChannels[i];
 }
 
 void MixerImpl::setReady(bool ready) {
-	Common::StackLock lock(_mutex);
-
-	_mixerReady = ready;
+	_mixerReady.store(ready);
 }
 
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
+void MixerImpl::queueCommand(const Command &cmd) {
+	_pendingCommands.push(cmd);
+	flushCommands();
+}
+
+void MixerImpl::queueVolumeUpdate(int index) {
+	uint16 volL, volR;
+	_channels[index]->getMixVolumes(volL, volR);
+	if (!_channels[index]->requestMixVolumes(volL, volR))
+		return;
+
+	Command cmd;
+	cmd.type = Command::kSetVolume;
+	cmd.index = index;
+	cmd.channel = _channels[index];
+	queueCommand(cmd);
+}
+
+void MixerImpl::queuePause(int index, bool paused) {
+	if (!_channels[index]->requestPause(paused, g_system->getMillis(true)))
+		return;
+
+	Command cmd;
+	cmd.type = Command::kPause;
+	cmd.index = index;
+	cmd.channel = _channels[index];
+	queueCommand(cmd);
+}
+
+void MixerImpl::flushCommands() {
+	const bool stalled = _callbackStalled && _callbackState.load() == _stalledState;
+
+	if (!s_inMixCallback && !stalled) {
+		while (!_pendingCommands.empty() && _commands.push(_pendingCommands.front()))
+			_pendingCommands.pop();
+
+		// The queue can only run full if the backend stopped calling
+		// mixCallback(), so apply the remaining commands directly then.
+		if (_pendingCommands.empty())
+			return;
+	}
+
+	// Never wait here: a mix pass which is running right now empties the
+	// queue, and the next call flushes the rest.
+	if (!s_inMixCallback && !enterAudioSide())
+		return;
+
+	// Commands which did not fit into the queue come after the queued ones
+	processCommands();
+	while (!_pendingCommands.empty())
+		applyCommand(_pendingCommands.pop());
+
+	if (s_inMixCallback)
+		return;
+	leaveAudioSide();
+
+	// Keep applying commands directly until the callback runs again
+	_callbackStalled = true;
+	_stalledState = _callbackState.load();
+}
+
+void MixerImpl::detachChannel(int index) {
+	Command cmd;
+	cmd.type = Command::kRemoveChannel;
+	cmd.index = index;
+	cmd.channel = _channels[index];
+	queueCommand(cmd);
+
+	_stoppedChannels.push_back(_channels[index]);
+	_channels[index] = 0;
+}
+
+void MixerImpl::reapFinishedChannels() {
+	// A stopped channel might be the one being mixed right now
+	if (s_inMixCallback)
+		return;
+
+	// The audio thread already dropped finished channels, so they can be
+	// deleted right away.
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i] && _channels[i]->hasFinished()) {
+			delete _channels[i];
+			_channels[i] = 0;
+		}
+	}
+
+	for (uint i = 0; i < _stoppedChannels.size(); ) {
+		if (_stoppedChannels[i]->hasFinished()) {
+			delete _stoppedChannels[i];
+			_stoppedChannels.remove_at(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void MixerImpl::waitForStoppedChannels() {
+	// Channels stopped from inside mixCallback() are dropped right away,
+	// but deleted on a later call, as one of them might be the caller.
+	if (s_inMixCallback)
+		return;
+
+	const uint32 startState = _callbackState.load();
+	const uint32 startTime = g_system->getMillis(true);
+
+	while (true) {
+		{
+			Common::StackLock lock(_mutex);
+
+			// No mix pass for a while means that the backend stopped
+			// calling mixCallback(), e.g. because audio is suspended.
+			if (!(startState & 1) && _callbackState.load() == startState &&
+			    g_system->getMillis(true) - startTime >= CALLBACK_STALL_TIME) {
+				_callbackStalled = true;
+				_stalledState = startState;
+			}
+
+			flushCommands();
+			reapFinishedChannels();
+			if (_stoppedChannels.empty())
+				return;
+		}
+
+		g_system->delayMillis(1);
+	}
+}
+
+bool MixerImpl::enterAudioSide() {
+	const uint32 state = _callbackState.load();
+	return !(state & 1) && _callbackState.compareExchange(state, state + 1);
+}
+
+void MixerImpl::leaveAudioSide() {
+	_callbackState.fetchAdd(1);
+}
+
+void MixerImpl::processCommands() {
+	Command cmd;
+	while (_commands.pop(cmd))
+		applyCommand(cmd);
+}
+
+void MixerImpl::applyCommand(const Command &cmd) {
+	switch (cmd.type) {
+	case Command::kAddChannel:
+		_mixChannels[cmd.index] = cmd.channel;
+		break;
+	case Command::kRemoveChannel:
+		if (_mixChannels[cmd.index] == cmd.channel)
+			_mixChannels[cmd.index] = 0;
+		// A stream can stop a channel, even its own, from within mix(), so
+		// the engine side may only delete it once the mix pass is over.
+		if (s_inMixCallback)
+			_removedChannels.push_back(cmd.channel);
+		else
+			cmd.channel->markFinished();
+		break;
+	case Command::kSetVolume:
+		if (_mixChannels[cmd.index] == cmd.channel)
+			cmd.channel->applyMixVolumes();
+		break;
+	case Command::kPause:
+		if (_mixChannels[cmd.index] == cmd.channel)
+			cmd.channel->applyPause();
+		break;
+	default:
+		break;
+	}
+}
+
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
@@ -219,6 +502,12 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	Command cmd;
+	cmd.type = Command::kAddChannel;
+	cmd.index = index;
+	cmd.channel = chan;
+	queueCommand(cmd);
 }
 
 void MixerImpl::playStream(
@@ -237,7 +526,9 @@ void MixerImpl::playStream(
 	}
 
 
-	assert(_mixerReady);
+	assert(isReady());
+
+	reapFinishedChannels();
 
 	// Prevent duplicate sounds
 	if (id != -1) {
@@ -260,85 +551,118 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, getRateConverterQuality(), &_sincFilterBanks);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
+
+	// The audio thread does not know about the channel yet, so the
+	// volumes can be set directly.
+	uint16 volL, volR;
+	chan->getMixVolumes(volL, volR);
+	chan->setMixVolumes(volL, volR);
+
 	insertChannel(handle, chan);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
+	// Since the mixer callback has been called, the mixer must be ready...
+	_mixerReady.store(true);
+
+	// An engine thread only stands in for the audio side when it found the
+	// callback stalled. Output silence rather than waiting for it.
+	if (!enterAudioSide()) {
+		memset(samples, 0, len);
+		return 0;
+	}
+	s_inMixCallback = true;
+
+	processCommands();
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
 	len >>= 2;
 
-	// Since the mixer callback has been called, the mixer must be ready...
-	_mixerReady = true;
-
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+		if (_mixChannels[i]) {
+			if (_mixChannels[i]->isFinished()) {
+				// The engine side deletes the channel once it notices
+				_mixChannels[i]->markFinished();
+				_mixChannels[i] = 0;
+			} else if (!_mixChannels[i]->isPaused()) {
+				tmp = _mixChannels[i]->mix(buf, len);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	// The engine side deletes the channel once it notices
+	for (uint i = 0; i < _removedChannels.size(); i++)
+		_removedChannels[i]->markFinished();
+	_removedChannels.resize(0);
+
+	s_inMixCallback = false;
+	leaveAudioSide();
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	{
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent())
+				detachChannel(i);
 		}
 	}
+
+	waitForStoppedChannels();
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	{
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == id)
+				detachChannel(i);
 		}
 	}
+
+	waitForStoppedChannels();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	{
+		Common::StackLock lock(_mutex);
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		// Simply ignore stop requests for handles of sounds that already terminated
+		const int index = handle._val % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+			return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+		detachChannel(index);
+	}
+
+	waitForStoppedChannels();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			queueVolumeUpdate(i);
 	}
 }
 
@@ -355,9 +679,12 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 		return;
 
 	_channels[index]->setVolume(volume);
+	queueVolumeUpdate(index);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -373,9 +700,12 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 		return;
 
 	_channels[index]->setBalance(balance);
+	queueVolumeUpdate(index);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -390,6 +720,8 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
+	reapFinishedChannels();
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return Timestamp(0, _sampleRate);
@@ -401,7 +733,7 @@ void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
+			queuePause(i, paused);
 		}
 	}
 }
@@ -410,7 +742,7 @@ void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+			queuePause(i, paused);
 			return;
 		}
 	}
@@ -424,7 +756,7 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	_channels[index]->pause(paused);
+	queuePause(index, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
@@ -434,6 +766,8 @@ bool MixerImpl::isSoundIDActive(int id) {
 	g_eventRec.updateSubsystems();
 #endif
 
+	reapFinishedChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
@@ -442,6 +776,8 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
@@ -455,12 +791,16 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	g_eventRec.updateSubsystems();
 #endif
 
+	reapFinishedChannels();
+
 	const int index = handle._val % NUM_CHANNELS;
 	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
@@ -481,7 +821,7 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			queueVolumeUpdate(i);
 	}
 }
 
@@ -497,16 +837,18 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 RateConverterQuality quality, SincFilterBankCache *filterBanks)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
-      _stream(stream, autofreeStream) {
+      _stream(stream, autofreeStream), _timingSeq(0), _finished(0), _requestedVolumes(0),
+      _requestedPauseLevel(0), _pauseRequestTime(0), _volumeUpdatePending(0), _pauseUpdatePending(0), _drained(false) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality, filterBanks);
 }
 
 Channel::~Channel() {
@@ -515,7 +857,6 @@ Channel::~Channel() {
 
 void Channel::setVolume(const byte volume) {
 	_volume = volume;
-	updateChannelVolumes();
 }
 
 byte Channel::getVolume() {
@@ -524,14 +865,13 @@ byte Channel::getVolume() {
 
 void Channel::setBalance(const int8 balance) {
 	_balance = balance;
-	updateChannelVolumes();
 }
 
 int8 Channel::getBalance() {
 	return _balance;
 }
 
-void Channel::updateChannelVolumes() {
+void Channel::getMixVolumes(uint16 &volL, uint16 &volR) const {
 	// From the channel balance/volume and the global volume, we compute
 	// the effective volume for the left and right channel. Note the
 	// slightly odd divisor: the 255 reflects the fact that the maximal
@@ -544,36 +884,79 @@ void Channel::updateChannelVolumes() {
 		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
 
 		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = vol / Mixer::kMaxChannelVolume;
 		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volR = vol / Mixer::kMaxChannelVolume;
 		}
 	} else {
-		_volL = _volR = 0;
+		volL = volR = 0;
 	}
 }
 
-void Channel::pause(bool paused) {
+void Channel::pause(bool paused, uint32 time) {
 	//assert((paused && _pauseLevel >= 0) || (!paused && _pauseLevel));
 
+	_timingSeq.fetchAdd(1);
+
 	if (paused) {
 		_pauseLevel++;
 
 		if (_pauseLevel == 1)
-			_pauseStartTime = g_system->getMillis(true);
+			_pauseStartTime = time;
 	} else if (_pauseLevel > 0) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+			_pauseTime = (time - _pauseStartTime);
 			_pauseStartTime = 0;
 		}
 	}
+
+	_timingSeq.fetchAdd(1);
+}
+
+bool Channel::requestPause(bool paused, uint32 time) {
+	int32 level = _requestedPauseLevel.load();
+	if (paused)
+		level++;
+	else if (level > 0)
+		level--;
+	else
+		return false;
+
+	_pauseRequestTime.store(time);
+	_requestedPauseLevel.store(level);
+	return _pauseUpdatePending.compareExchange(0, 1);
+}
+
+void Channel::applyPause() {
+	// Clear the flag first, so that a request racing with us notifies
+	// the audio thread again
+	_pauseUpdatePending.store(0);
+
+	const int32 level = _requestedPauseLevel.load();
+	const uint32 time = _pauseRequestTime.load();
+	while (_pauseLevel < level)
+		pause(true, time);
+	while (_pauseLevel > level)
+		pause(false, time);
+}
+
+bool Channel::requestMixVolumes(uint16 volL, uint16 volR) {
+	_requestedVolumes.store(((uint32)volL << 16) | volR);
+	return _volumeUpdatePending.compareExchange(0, 1);
+}
+
+void Channel::applyMixVolumes() {
+	_volumeUpdatePending.store(0);
+
+	const uint32 volumes = _requestedVolumes.load();
+	setMixVolumes(volumes >> 16, volumes & 0xFFFF);
 }
 
 Timestamp Channel::getElapsedTime() {
@@ -582,17 +965,30 @@ Timestamp Channel::getElapsedTime() {
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	// Take a consistent snapshot of the timing information, which the
+	// audio thread may be updating right now.
+	uint32 seq, samplesConsumed, mixerTimeStamp, pauseStartTime, pauseTime;
+	int pauseLevel;
+	do {
+		seq = _timingSeq.load();
+		samplesConsumed = _samplesConsumed;
+		mixerTimeStamp = _mixerTimeStamp;
+		pauseStartTime = _pauseStartTime;
+		pauseTime = _pauseTime;
+		pauseLevel = _pauseLevel;
+	} while ((seq & 1) || seq != _timingSeq.load());
+
+	if (mixerTimeStamp == 0)
 		return ts;
 
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
+	if (pauseLevel != 0)
+		delta = pauseStartTime - mixerTimeStamp;
 	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+		delta = g_system->getMillis(true) - mixerTimeStamp - pauseTime;
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -609,13 +1005,25 @@ int Channel::mix(int16 *data, uint len) {
 
 	int res = 0;
 	if (_stream->endOfData()) {
-		// TODO: call drain method
+		// Once the stream has ended, output what the converter still holds back
+		if (_stream->endOfStream() && !_drained) {
+			res = _converter->drain(data, len, _volL, _volR);
+			_drained = ((uint)res < len);
+			_samplesDecoded += res;
+		}
 	} else {
 		assert(_converter);
+		_timingSeq.fetchAdd(1);
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
+		_timingSeq.fetchAdd(1);
 		res = _converter->flow(*_stream, data, len, _volL, _volR);
+		if ((uint)res < len && _stream->endOfStream()) {
+			const int drained = _converter->drain(data + res * 2, len - res, _volL, _volR);
+			_drained = ((uint)drained < len - res);
+			res += drained;
+		}
 		_samplesDecoded += res;
 	}
 
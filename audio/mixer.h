@@ -49,6 +49,12 @@ public:
 /**
  * The main audio mixer handles mixing of an arbitrary number of
  * audio streams (in the form of AudioStream instances).
+ *
+ * Volume, balance and pause changes take effect with the next mix pass.
+ * Until then, getElapsedTime() keeps reporting the old state, e.g. a sound
+ * which was just paused may still appear to be advancing. Likewise, a sound
+ * whose stream just ended stays active (see isSoundHandleActive()) until a
+ * mix pass notices it.
  */
 class Mixer : Common::NonCopyable {
 public:
@@ -130,6 +136,10 @@ public:
 	/**
 	 * Stop playing the sound corresponding to the given handle.
 	 *
+	 * Once the stop methods return, the stream is not used by the mixer
+	 * anymore. When called from within the mixer callback, e.g. from
+	 * AudioStream::readBuffer(), the stream is deleted on a later call.
+	 *
 	 * @param handle the sound to affect
 	 */
 	virtual void stopHandle(SoundHandle handle) = 0;
@@ -154,6 +164,7 @@ public:
 
 	/**
 	 * Pause/unpause the sound corresponding to the given handle.
+	 * The change takes effect with the next mix pass.
 	 *
 	 * @param handle the sound to affect
 	 * @param paused true to pause the sound, false to unpause it
@@ -204,6 +215,7 @@ public:
 
 	/**
 	 * Set the channel volume for the given handle.
+	 * The change takes effect with the next mix pass.
 	 *
 	 * @param handle the sound to affect
 	 * @param volume the new channel volume (0 - kMaxChannelVolume)
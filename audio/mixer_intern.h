@@ -24,8 +24,13 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/lockfree-queue.h"
 #include "common/mutex.h"
+#include "common/queue.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -42,6 +47,19 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * The mixer callback never waits for engine threads: all channel changes
+ * are posted to a lock-free command queue which mixCallback() drains before
+ * mixing. The engine side keeps its own view of the channels, so queries
+ * like isSoundHandleActive() answer immediately. Only the stop methods
+ * wait until the audio side dropped the stopped channels, so that the
+ * stream can be safely deleted once they return.
+ *
+ * When the backend stops calling mixCallback() (e.g. while audio is
+ * suspended), the engine side applies the commands itself instead. Mixer
+ * calls made from within mixCallback(), e.g. by AudioStream::readBuffer()
+ * or a MIDI driver, are applied directly as well; channels stopped that way
+ * are deleted on a later mixer call.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -51,13 +69,36 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		COMMAND_QUEUE_SIZE = 1024,
+		/** Time without a mix pass after which the callback is considered stalled, in ms */
+		CALLBACK_STALL_TIME = 100
+	};
+
+	/**
+	 * A channel change posted by an engine thread, to be applied by the
+	 * audio thread at the start of the next mixCallback(). Volume and pause
+	 * commands fetch the latest settings from the channel, so at most one of
+	 * each is queued per channel.
+	 */
+	struct Command {
+		enum Type {
+			kAddChannel,
+			kRemoveChannel,
+			kSetVolume,
+			kPause
+		};
+
+		Type type;
+		int index;
+		Channel *channel;
 	};
 
+	/** Serializes the engine side, never locked by mixCallback() */
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
-	bool _mixerReady;
+	Common::Atomic<int32> _mixerReady;
 	uint32 _handleSeed;
 
 	struct SoundTypeSettings {
@@ -68,15 +109,43 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	/** Channels as seen by the engine side, which owns them */
 	Channel *_channels[NUM_CHANNELS];
 
+	/** Channels as seen by the audio thread, only used by mixCallback() */
+	Channel *_mixChannels[NUM_CHANNELS];
+
+	/** Channels removed during the current mix pass, only used by mixCallback() */
+	Common::Array<Channel *> _removedChannels;
+
+	Common::LockFreeQueue<Command> _commands;
+
+	/** Commands which did not fit into _commands yet. Must hold _mutex. */
+	Common::Queue<Command> _pendingCommands;
+
+	/** Stopped channels, deleted once the audio side dropped them. Must hold _mutex. */
+	Common::Array<Channel *> _stoppedChannels;
+
+	/**
+	 * Number of times the audio side was entered plus left, odd while
+	 * mixCallback() or an engine thread standing in for it owns _mixChannels.
+	 */
+	Common::Atomic<uint32> _callbackState;
+
+	/** Set when the callback stopped running as of _stalledState. Must hold _mutex. */
+	bool _callbackStalled;
+	uint32 _stalledState;
+
+	/** Filter banks shared by the sinc rate converters of all channels */
+	SincFilterBankCache _sincFilterBanks;
 
 public:
 
 	MixerImpl(uint sampleRate);
 	~MixerImpl();
 
-	virtual bool isReady() const { Common::StackLock lock(_mutex); return _mixerReady; }
+	virtual bool isReady() const { return _mixerReady.load() != 0; }
 
 	virtual void playStream(
 		SoundType type,
@@ -121,6 +190,28 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/** Post a command for the audio thread. Must hold _mutex. */
+	void queueCommand(const Command &cmd);
+	void queueVolumeUpdate(int index);
+	void queuePause(int index, bool paused);
+	/**
+	 * Hand pending commands to the audio thread, or apply them directly if
+	 * the callback is not running. Must hold _mutex.
+	 */
+	void flushCommands();
+	/** Detach a channel from the audio thread. Must hold _mutex. */
+	void detachChannel(int index);
+	/** Delete channels the audio thread dropped. Must hold _mutex. */
+	void reapFinishedChannels();
+	/** Wait until the audio thread dropped all stopped channels. Must not hold _mutex. */
+	void waitForStoppedChannels();
+	/** Take over _mixChannels, unless somebody else is using them. */
+	bool enterAudioSide();
+	void leaveAudioSide();
+	/** Apply all queued commands. Must own the audio side. */
+	void processCommands();
+	void applyCommand(const Command &cmd);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
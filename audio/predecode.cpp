@@ -0,0 +1,335 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/predecode.h"
+#include "audio/audiostream.h"
+#include "audio/timestamp.h"
+
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/config-manager.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/singleton.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+namespace Audio {
+
+class PreDecodingStream;
+
+/**
+ * Drives all pre-decoding streams from a single timer callback.
+ *
+ * Timer procs are identified by their function pointer only, so the
+ * streams cannot each install their own.
+ */
+class PreDecoder : public Common::Singleton<PreDecoder> {
+public:
+	void addStream(PreDecodingStream *stream);
+	void removeStream(PreDecodingStream *stream);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	PreDecoder() : _timerInstalled(false) {}
+
+	static void timerProc(void *refCon);
+
+	/** Protects _streams; held while decoding, so removed streams are idle */
+	Common::Mutex _mutex;
+	Common::Array<PreDecodingStream *> _streams;
+
+	/**
+	 * Serializes installing and removing the timer. Never locked by
+	 * timerProc(), unlike _mutex, so the timer manager can be called with
+	 * it held.
+	 */
+	Common::Mutex _timerMutex;
+	bool _timerInstalled;
+};
+
+/**
+ * Stream wrapper which decodes its parent ahead of time into a lock-free
+ * ring buffer.
+ *
+ * The ring has a single producer, the timer callback, and a single
+ * consumer, the thread calling readBuffer() (usually the mixer). Whoever
+ * uses _parent must own it through tryLockParent() first, which the
+ * consumer never waits for.
+ */
+class PreDecodingStream : public SeekableAudioStream {
+public:
+	PreDecodingStream(SeekableAudioStream *parent, DisposeAfterUse::Flag disposeAfterUse);
+	~PreDecodingStream();
+
+	int readBuffer(int16 *buffer, const int numSamples);
+	bool endOfData() const;
+
+	bool isStereo() const { return _isStereo; }
+	int getRate() const { return _rate; }
+
+	bool seek(const Timestamp &where);
+	Timestamp getLength() const;
+
+	/** Fill the ring buffer as far as possible. Called by PreDecoder. */
+	void decodeAhead();
+
+private:
+	enum {
+		/** Number of samples decoded in one go */
+		kChunkSize = 2048
+	};
+
+	int readFromRing(int16 *buffer, int numSamples);
+	void applyDiscard();
+
+	bool tryLockParent() { return _parentOwned.compareExchange(0, 1); }
+	/** Wait until the parent is not used. Never called by the consumer. */
+	void lockParent() const;
+	void unlockParent() const { _parentOwned.store(0); }
+
+	Common::DisposablePtr<SeekableAudioStream> _parent;
+	const bool _isStereo;
+	const int _rate;
+
+	/** Serializes the engine and timer sides, never locked by readBuffer() */
+	Common::Mutex _decoderMutex;
+	/** Set while a thread uses _parent, see tryLockParent() */
+	mutable Common::Atomic<int32> _parentOwned;
+
+	int16 *_ring;
+	uint32 _ringSize;
+
+	/** Position of the next sample to decode, only written by the producer */
+	Common::Atomic<uint32> _writePos;
+	/** Position of the next sample to play, only written by the consumer */
+	Common::Atomic<uint32> _readPos;
+	/** Samples before this position were decoded before the last seek */
+	Common::Atomic<uint32> _discardPos;
+	/** Whether the producer reached the end of the parent stream */
+	Common::Atomic<int32> _parentEnded;
+};
+
+PreDecodingStream::PreDecodingStream(SeekableAudioStream *parent, DisposeAfterUse::Flag disposeAfterUse)
+	: _parent(parent, disposeAfterUse), _isStereo(parent->isStereo()), _rate(parent->getRate()),
+	  _parentOwned(0), _writePos(0), _readPos(0), _discardPos(0), _parentEnded(parent->endOfData()) {
+
+	// Keep about half a second of audio around
+	const uint32 wanted = MAX<uint32>(_rate * (_isStereo ? 2 : 1) / 2, kChunkSize * 2);
+	_ringSize = 1;
+	while (_ringSize < wanted)
+		_ringSize <<= 1;
+	_ring = new int16[_ringSize];
+
+	PreDecoder::instance().addStream(this);
+}
+
+PreDecodingStream::~PreDecodingStream() {
+	PreDecoder::instance().removeStream(this);
+	delete[] _ring;
+}
+
+void PreDecodingStream::lockParent() const {
+	// The consumer only owns the parent for a single read
+	while (!_parentOwned.compareExchange(0, 1))
+		g_system->delayMillis(1);
+}
+
+void PreDecodingStream::decodeAhead() {
+	Common::StackLock lock(_decoderMutex);
+
+	while (!_parentEnded.load()) {
+		const uint32 writePos = _writePos.load();
+		const uint32 space = _ringSize - (writePos - _readPos.load());
+		const uint32 offset = writePos & (_ringSize - 1);
+
+		// Never wrap around inside a single parent read. Since the ring
+		// size is even, this keeps stereo frames together.
+		const uint32 count = MIN<uint32>(MIN<uint32>(space, _ringSize - offset), kChunkSize);
+		if (count < kChunkSize && count < _ringSize - offset)
+			break;
+
+		// Only own the parent for one chunk at a time, so that the consumer
+		// is kept waiting as briefly as possible. If it is decoding itself
+		// right now, try again on the next timer tick.
+		if (!tryLockParent())
+			break;
+
+		const int got = _parent->readBuffer(_ring + offset, count);
+		if (got > 0)
+			_writePos.store(writePos + got);
+
+		if (got < (int)count || _parent->endOfData())
+			_parentEnded.store(_parent->endOfData());
+		unlockParent();
+
+		if (got <= 0)
+			break;
+	}
+}
+
+void PreDecodingStream::applyDiscard() {
+	const uint32 discardPos = _discardPos.load();
+	if ((int32)(discardPos - _readPos.load()) > 0)
+		_readPos.store(discardPos);
+}
+
+int PreDecodingStream::readFromRing(int16 *buffer, int numSamples) {
+	applyDiscard();
+
+	uint32 readPos = _readPos.load();
+	const uint32 available = _writePos.load() - readPos;
+	int samples = MIN<uint32>(available, numSamples);
+
+	int remaining = samples;
+	while (remaining > 0) {
+		const uint32 offset = readPos & (_ringSize - 1);
+		const int count = MIN<uint32>(remaining, _ringSize - offset);
+		memcpy(buffer, _ring + offset, count * sizeof(int16));
+		buffer += count;
+		readPos += count;
+		remaining -= count;
+	}
+
+	_readPos.store(readPos);
+	return samples;
+}
+
+int PreDecodingStream::readBuffer(int16 *buffer, const int numSamples) {
+	int samples = readFromRing(buffer, numSamples);
+
+	// The decoder could not keep up: decode the rest right here, just like
+	// without pre-decoding. Never wait for the producer though. If it is
+	// decoding a chunk right now, that will be in the ring next time.
+	if (samples < numSamples && !_parentEnded.load() && tryLockParent()) {
+		// The producer might have added some more data in the meantime,
+		// so check the ring again first.
+		samples += readFromRing(buffer + samples, numSamples - samples);
+		if (samples < numSamples && !_parentEnded.load()) {
+			samples += _parent->readBuffer(buffer + samples, numSamples - samples);
+			_parentEnded.store(_parent->endOfData());
+		}
+		unlockParent();
+	}
+
+	return samples;
+}
+
+bool PreDecodingStream::endOfData() const {
+	if (!_parentEnded.load())
+		return false;
+
+	const uint32 discardPos = _discardPos.load();
+	const uint32 readPos = ((int32)(discardPos - _readPos.load()) > 0) ? discardPos : _readPos.load();
+	return readPos == _writePos.load();
+}
+
+bool PreDecodingStream::seek(const Timestamp &where) {
+	Common::StackLock lock(_decoderMutex);
+	lockParent();
+
+	const bool result = _parent->seek(where);
+
+	// Everything decoded so far is stale now. The producer is stopped by
+	// the mutex, so the write position is stable.
+	_discardPos.store(_writePos.load());
+	_parentEnded.store(_parent->endOfData());
+
+	unlockParent();
+	return result;
+}
+
+Timestamp PreDecodingStream::getLength() const {
+	Common::StackLock lock(const_cast<Common::Mutex &>(_decoderMutex));
+	lockParent();
+	const Timestamp length = _parent->getLength();
+	unlockParent();
+	return length;
+}
+
+#pragma mark -
+
+void PreDecoder::addStream(PreDecodingStream *stream) {
+	Common::StackLock timerLock(_timerMutex);
+	{
+		Common::StackLock lock(_mutex);
+		_streams.push_back(stream);
+	}
+
+	// The timer manager must not be called with _mutex held, since it
+	// holds its own mutex while calling timerProc().
+	if (!_timerInstalled) {
+		g_system->getTimerManager()->installTimerProc(&timerProc, 10000, this, "audioPreDecoder");
+		_timerInstalled = true;
+	}
+}
+
+void PreDecoder::removeStream(PreDecodingStream *stream) {
+	Common::StackLock timerLock(_timerMutex);
+	bool empty;
+	{
+		Common::StackLock lock(_mutex);
+
+		for (uint i = 0; i < _streams.size(); ++i) {
+			if (_streams[i] == stream) {
+				_streams.remove_at(i);
+				break;
+			}
+		}
+		empty = _streams.empty();
+	}
+
+	if (empty && _timerInstalled) {
+		g_system->getTimerManager()->removeTimerProc(&timerProc);
+		_timerInstalled = false;
+	}
+}
+
+void PreDecoder::timerProc(void *refCon) {
+	PreDecoder *decoder = (PreDecoder *)refCon;
+	Common::StackLock lock(decoder->_mutex);
+
+	for (uint i = 0; i < decoder->_streams.size(); ++i)
+		decoder->_streams[i]->decodeAhead();
+}
+
+#pragma mark -
+
+SeekableAudioStream *makePreDecodingStream(SeekableAudioStream *stream, DisposeAfterUse::Flag disposeAfterUse) {
+	if (!stream)
+		return 0;
+
+	return new PreDecodingStream(stream, disposeAfterUse);
+}
+
+SeekableAudioStream *makePreDecodingStreamIfEnabled(SeekableAudioStream *stream) {
+	if (!stream || !ConfMan.getBool("audio_predecode"))
+		return stream;
+
+	return makePreDecodingStream(stream, DisposeAfterUse::YES);
+}
+
+} // End of namespace Audio
+
+namespace Common {
+DECLARE_SINGLETON(Audio::PreDecoder);
+}
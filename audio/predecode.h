@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_PREDECODE_H
+#define AUDIO_PREDECODE_H
+
+#include "common/scummsys.h"
+#include "common/types.h"
+
+namespace Audio {
+
+/**
+ * @defgroup audio_predecode Pre-decoding
+ * @ingroup audio
+ *
+ * @brief Decoding compressed audio ahead of playback.
+ * @{
+ */
+
+class SeekableAudioStream;
+
+/**
+ * Wrap a stream so that it is decoded ahead of playback from a timer
+ * callback, instead of inside the mixer callback.
+ *
+ * The decoded samples are kept in a ring buffer of roughly half a second,
+ * which the mixer reads from without waiting for the decoder. Should the
+ * buffer ever run empty, the missing samples are decoded synchronously,
+ * just like without the wrapper, unless the timer callback is decoding
+ * that very moment. Seeking or rewinding flushes the buffer and restarts
+ * decoding at the new position.
+ *
+ * @param stream          the stream to decode ahead
+ * @param disposeAfterUse whether to delete the stream with the wrapper
+ * @return a new SeekableAudioStream
+ */
+SeekableAudioStream *makePreDecodingStream(SeekableAudioStream *stream,
+                                           DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::YES);
+
+/**
+ * Wrap a stream with makePreDecodingStream() if the user enabled the
+ * "audio_predecode" option, otherwise return it unchanged.
+ *
+ * This is used by the factory functions of the compressed formats, so
+ * engines get pre-decoding without any changes.
+ *
+ * @param stream the stream to wrap, which will be owned by the wrapper
+ * @return the wrapped stream, or @p stream itself
+ */
+SeekableAudioStream *makePreDecodingStreamIfEnabled(SeekableAudioStream *stream);
+
+/** @} */
+
+} // End of namespace Audio
+
+#endif
@@ -31,10 +31,23 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/algorithm.h"
+#include "common/array.h"
 #include "common/frac.h"
+#include "common/ptr.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#if defined(__SSE2__)
+#define RATE_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define RATE_USE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 namespace Audio {
 
 
@@ -57,6 +70,111 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Scale a block of input frames by the channel volumes and mix them into
+ * the (always stereo) output buffer, saturating the result.
+ *
+ * This is the common tail of all rate converters. When SSE2 or NEON are
+ * available, four frames are processed at a time with the saturation done
+ * in vector registers; the results are bit-identical to the scalar code,
+ * which also handles any remaining frames.
+ *
+ * @param obuf   output buffer, receives 2 * frames samples
+ * @param ibuf   input buffer, holds frames samples (mono) or 2 * frames
+ *               samples (stereo)
+ * @param frames number of sample frames to mix
+ */
+template<bool stereo, bool reverseStereo>
+static void mixBlock(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+#if defined(RATE_USE_SSE2) || defined(RATE_USE_NEON)
+	// The vector code divides by kMaxMixerVolume with a shift.
+	STATIC_ASSERT(Audio::Mixer::kMaxMixerVolume == 256, kMaxMixerVolume_must_be_256);
+
+	// After the optional channel swap below, even lanes end up in the left
+	// output channel and odd lanes in the right one.
+	const int16 volEven = (reverseStereo ? vol_r : vol_l);
+	const int16 volOdd  = (reverseStereo ? vol_l : vol_r);
+#endif
+
+#if defined(RATE_USE_SSE2)
+	const __m128i vol = _mm_set_epi16(volOdd, volEven, volOdd, volEven, volOdd, volEven, volOdd, volEven);
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	for (; frames >= 4; frames -= 4) {
+		__m128i in;
+		if (stereo) {
+			in = _mm_loadu_si128((const __m128i *)ibuf);
+			if (reverseStereo) {
+				in = _mm_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+				in = _mm_shufflehi_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+			}
+			ibuf += 8;
+		} else {
+			in = _mm_loadl_epi64((const __m128i *)ibuf);
+			in = _mm_unpacklo_epi16(in, in);
+			ibuf += 4;
+		}
+
+		// Full 32 bit products of sample * volume
+		const __m128i lo = _mm_mullo_epi16(in, vol);
+		const __m128i hi = _mm_mulhi_epi16(in, vol);
+		__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+		__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+		// Divide by kMaxMixerVolume, rounding towards zero like C division
+		p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+		p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+
+		const __m128i out = _mm_adds_epi16(_mm_loadu_si128((const __m128i *)obuf), _mm_packs_epi32(p0, p1));
+		_mm_storeu_si128((__m128i *)obuf, out);
+		obuf += 8;
+	}
+#elif defined(RATE_USE_NEON)
+	const int16 volLanes[8] = { volEven, volOdd, volEven, volOdd, volEven, volOdd, volEven, volOdd };
+	const int16x8_t vol = vld1q_s16(volLanes);
+
+	for (; frames >= 4; frames -= 4) {
+		int16x8_t in;
+		if (stereo) {
+			in = vld1q_s16(ibuf);
+			if (reverseStereo)
+				in = vrev32q_s16(in);
+			ibuf += 8;
+		} else {
+			const int16x4_t mono = vld1_s16(ibuf);
+			const int16x4x2_t dup = vzip_s16(mono, mono);
+			in = vcombine_s16(dup.val[0], dup.val[1]);
+			ibuf += 4;
+		}
+
+		int32x4_t p0 = vmull_s16(vget_low_s16(in), vget_low_s16(vol));
+		int32x4_t p1 = vmull_s16(vget_high_s16(in), vget_high_s16(vol));
+
+		// Divide by kMaxMixerVolume, rounding towards zero like C division
+		p0 = vaddq_s32(p0, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p0, 31)), 24)));
+		p1 = vaddq_s32(p1, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p1, 31)), 24)));
+
+		const int16x8_t out = vqaddq_s16(vld1q_s16(obuf), vcombine_s16(vshrn_n_s32(p0, 8), vshrn_n_s32(p1, 8)));
+		vst1q_s16(obuf, out);
+		obuf += 8;
+	}
+#endif
+
+	for (; frames > 0; --frames) {
+		st_sample_t out0, out1;
+		out0 = *ibuf++;
+		out1 = (stereo ? *ibuf++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -70,6 +188,9 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled frames waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -80,7 +201,7 @@ protected:
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
-	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		return ST_SUCCESS;
 	}
 };
@@ -118,38 +239,46 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		// Resample into the intermediate output buffer first, then mix the
+		// whole block at once
+		st_sample_t *tmp = outBuf;
+		const st_sample_t *tmpEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf) / 2, (oend - obuf) / 2) * (stereo ? 2 : 1);
+
+		while (tmp < tmpEnd) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*tmp++ = *inPtr++;
+			if (stereo)
+				*tmp++ = *inPtr++;
 
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		obuf += 2;
+		const st_size_t frames = (tmp - outBuf) / (stereo ? 2 : 1);
+		mixBlock<stereo, reverseStereo>(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -183,10 +312,13 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated frames waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
-	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		return ST_SUCCESS;
 	}
 };
@@ -227,48 +359,357 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		// Interpolate into the intermediate output buffer first, then mix
+		// the whole block at once
+		st_sample_t *tmp = outBuf;
+		const st_sample_t *tmpEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf) / 2, (oend - obuf) / 2) * (stereo ? 2 : 1);
+
+		while (tmp < tmpEnd) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the intermediate buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && tmp < tmpEnd) {
+				// interpolate
+				*tmp++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*tmp++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
+		const st_size_t frames = (tmp - outBuf) / (stereo ? 2 : 1);
+		mixBlock<stereo, reverseStereo>(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
+	}
+	return (obuf - ostart) / 2;
+}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+#pragma mark -
 
-			obuf += 2;
+
+/**
+ * Polyphase filter bank for windowed sinc interpolation between two rates.
+ *
+ * Filter banks are immutable once created, so a SincFilterBankCache can
+ * share them between all converters for the same rates and filter length.
+ */
+struct SincFilterBank {
+	~SincFilterBank() { delete[] coeffs; }
+
+	st_rate_t inrate, outrate;
+	int taps;
+
+	/** Output position increment, in units of 1 / phaseDenominator input samples */
+	uint32 phaseStep;
+	/** Number of sub-sample positions per input sample */
+	uint32 phaseDenominator;
+	/** Number of stored filter phases, at most kMaxSincPhases */
+	uint32 numPhases;
+
+	/** numPhases * taps coefficients, scaled by 1 << SINC_COEFF_BITS */
+	int16 *coeffs;
+
+	const int16 *getPhase(uint32 phase) const {
+		if (numPhases != phaseDenominator)
+			phase = (uint32)(((uint64)phase * numPhases) / phaseDenominator);
+		return coeffs + phase * taps;
+	}
+};
+
+enum {
+	/**
+	 * The coefficients have 14 fractional bits, which keeps the sum of the
+	 * products in 32 bits even for full scale input.
+	 */
+	SINC_COEFF_BITS = 14,
+	kMaxSincPhases = 1024
+};
+
+/** Zeroth order modified Bessel function of the first kind, for the Kaiser window */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static SincFilterBank *createSincFilterBank(st_rate_t inrate, st_rate_t outrate, int taps) {
+	SincFilterBank *bank = new SincFilterBank;
+	bank->inrate = inrate;
+	bank->outrate = outrate;
+	bank->taps = taps;
+
+	const uint32 gcd = Common::gcd<uint32>(inrate, outrate);
+	bank->phaseDenominator = outrate / gcd;
+	bank->phaseStep = inrate / gcd;
+	bank->numPhases = MIN<uint32>(bank->phaseDenominator, kMaxSincPhases);
+	bank->coeffs = new int16[bank->numPhases * taps];
+
+	// Cut off slightly below the lower of the two Nyquist frequencies
+	const double cutoff = 0.91 * MIN<double>(1.0, (double)outrate / inrate);
+	const double beta = (taps >= 32) ? 8.0 : 6.0;
+	const double windowNorm = besselI0(beta);
+	const int half = taps / 2;
+
+	for (uint32 phase = 0; phase < bank->numPhases; ++phase) {
+		const double frac = (double)phase / bank->numPhases;
+		double h[64];
+		double sum = 0.0;
+
+		for (int k = 0; k < taps; ++k) {
+			// Distance between the output position and input sample k
+			const double x = frac + (half - 1 - k);
+			const double r = x / half;
+			const double window = (r <= -1.0 || r >= 1.0) ? 0.0 : besselI0(beta * sqrt(1.0 - r * r)) / windowNorm;
+			const double arg = M_PI * cutoff * x;
+			const double sinc = (fabs(arg) < 1e-9) ? 1.0 : sin(arg) / arg;
+			h[k] = cutoff * sinc * window;
+			sum += h[k];
+		}
+
+		// Normalize every phase to unity gain
+		int16 *out = bank->coeffs + phase * taps;
+		for (int k = 0; k < taps; ++k)
+			out[k] = (int16)floor(h[k] / sum * (1 << SINC_COEFF_BITS) + 0.5);
+	}
+
+	return bank;
+}
+
+SincFilterBankCache::~SincFilterBankCache() {
+	for (uint i = 0; i < _banks.size(); ++i)
+		delete _banks[i];
+}
+
+const SincFilterBank *SincFilterBankCache::get(st_rate_t inrate, st_rate_t outrate, int taps) {
+	// Converters are usually created from engine threads
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _banks.size(); ++i) {
+		const SincFilterBank *bank = _banks[i];
+		if (bank->inrate == inrate && bank->outrate == outrate && bank->taps == taps)
+			return bank;
+	}
+
+	SincFilterBank *bank = createSincFilterBank(inrate, outrate, taps);
+	_banks.push_back(bank);
+	return bank;
+}
+
+/**
+ * Compute one filtered sample, i.e. the dot product of taps input samples
+ * and coefficients. taps must be a multiple of 8. The vector versions sum
+ * up in a different order, which gives identical results as nothing
+ * overflows.
+ */
+static inline int32 sincDotProduct(const st_sample_t *samples, const int16 *coeffs, int taps) {
+#if defined(RATE_USE_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	for (int k = 0; k < taps; k += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + k));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coeffs + k));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(s, c));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(acc);
+#elif defined(RATE_USE_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for (int k = 0; k < taps; k += 8) {
+		const int16x8_t s = vld1q_s16(samples + k);
+		const int16x8_t c = vld1q_s16(coeffs + k);
+		acc = vmlal_s16(acc, vget_low_s16(s), vget_low_s16(c));
+		acc = vmlal_s16(acc, vget_high_s16(s), vget_high_s16(c));
+	}
+	const int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	return vget_lane_s32(vpadd_s32(sum, sum), 0);
+#else
+	int32 acc = 0;
+	for (int k = 0; k < taps; ++k)
+		acc += samples[k] * coeffs[k];
+	return acc;
+#endif
+}
+
+/**
+ * Audio rate converter based on band-limited interpolation with a
+ * polyphase windowed sinc filter. Compared to the linear converter this
+ * avoids most aliasing, at the cost of taps multiplications per sample.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		kMaxTaps = 64,
+		kHistorySize = INTERMEDIATE_BUFFER_SIZE + kMaxTaps
+	};
+
+	/** filter bank computed for this converter only, if there is no cache */
+	Common::ScopedPtr<SincFilterBank> _ownBank;
+	const SincFilterBank *_bank;
+	const int _taps;
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** deinterleaved input history per channel */
+	st_sample_t _history[stereo ? 2 : 1][kHistorySize];
+	/** number of valid samples in each history buffer */
+	int _historyLen;
+	/** index of the first sample of the current filter window */
+	int _pos;
+	/** sub-sample position, in units of 1 / phaseDenominator */
+	uint32 _phase;
+	/** whether the silence after the end of the input has been appended */
+	bool _flushed;
+
+	/** filtered frames waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	bool refill(AudioStream *input);
+	int filter(AudioStream *input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate, int taps, SincFilterBankCache *filterBanks);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return filter(&input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return filter(nullptr, obuf, osamp, vol_l, vol_r);
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate, int taps, SincFilterBankCache *filterBanks)
+	: _taps(taps), _pos(0), _phase(0), _flushed(false) {
+	assert(taps % 8 == 0 && taps <= kMaxTaps);
+
+	if (filterBanks) {
+		_bank = filterBanks->get(inrate, outrate, taps);
+	} else {
+		_ownBank.reset(createSincFilterBank(inrate, outrate, taps));
+		_bank = _ownBank.get();
+	}
+
+	// Start with half a window of silence, so that the first output sample
+	// is centered on the first input sample.
+	_historyLen = taps / 2 - 1;
+	memset(_history, 0, sizeof(_history));
+}
+
+/*
+ * Append more input to the history buffers, dropping samples which are
+ * no longer needed. Without an input stream, i.e. when draining, half a
+ * window of silence is appended once, so that the last output sample is
+ * centered on the last input sample. Returns false when there is nothing
+ * left to append.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream *input) {
+	if (_pos >= _historyLen) {
+		// When downsampling, the window can start beyond the buffered input
+		_pos -= _historyLen;
+		_historyLen = 0;
+	} else {
+		const int keep = _historyLen - _pos;
+		for (int ch = 0; ch < (stereo ? 2 : 1); ++ch)
+			memmove(_history[ch], _history[ch] + _pos, keep * sizeof(st_sample_t));
+		_historyLen = keep;
+		_pos = 0;
+	}
+
+	if (!input) {
+		if (_flushed)
+			return false;
+		for (int ch = 0; ch < (stereo ? 2 : 1); ++ch)
+			memset(_history[ch] + _historyLen, 0, (_taps / 2) * sizeof(st_sample_t));
+		_historyLen += _taps / 2;
+		_flushed = true;
+		return true;
+	}
+
+	const int space = (kHistorySize - _historyLen) * (stereo ? 2 : 1);
+	const int len = input->readBuffer(inBuf, MIN<int>(space, ARRAYSIZE(inBuf)));
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *in = inBuf;
+	for (int i = 0; i < len / (stereo ? 2 : 1); ++i) {
+		_history[0][_historyLen] = *in++;
+		if (stereo)
+			_history[1][_historyLen] = *in++;
+		_historyLen++;
+	}
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::filter(AudioStream *input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		st_sample_t *tmp = outBuf;
+		const st_sample_t *tmpEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf) / 2, (oend - obuf) / 2) * (stereo ? 2 : 1);
+
+		while (tmp < tmpEnd) {
+			// Make sure the whole filter window is available
+			if (_pos + _taps > _historyLen && !refill(input)) {
+				endOfInput = true;
+				break;
+			}
+			if (_pos + _taps > _historyLen)
+				continue;
+
+			const int16 *coeffs = _bank->getPhase(_phase);
+			for (int ch = 0; ch < (stereo ? 2 : 1); ++ch) {
+				const int32 acc = sincDotProduct(_history[ch] + _pos, coeffs, _taps);
+				*tmp++ = (st_sample_t)CLIP<int32>((acc + (1 << (SINC_COEFF_BITS - 1))) >> SINC_COEFF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			}
 
 			// Increment output position
-			opos += opos_inc;
+			_phase += _bank->phaseStep;
+			if (_phase >= _bank->phaseDenominator) {
+				_pos += _phase / _bank->phaseDenominator;
+				_phase %= _bank->phaseDenominator;
+			}
 		}
+
+		const st_size_t frames = (tmp - outBuf) / (stereo ? 2 : 1);
+		mixBlock<stereo, reverseStereo>(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -293,7 +734,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
 		st_sample_t *ostart = obuf;
@@ -315,24 +755,14 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		const st_size_t frames = len / (stereo ? 2 : 1);
+		mixBlock<stereo, reverseStereo>(obuf, _buffer, frames, vol_l, vol_r);
+		obuf += frames * 2;
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
 		return (obuf - ostart) / 2;
 	}
 
-	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		return ST_SUCCESS;
 	}
 };
@@ -341,9 +771,13 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality, SincFilterBankCache *filterBanks) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (quality == kRateConverterSincHigh) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate, 32, filterBanks);
+		} else if (quality == kRateConverterSincMedium) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate, 16, filterBanks);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +790,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality, SincFilterBankCache *filterBanks) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality, filterBanks);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality, filterBanks);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality, filterBanks);
 }
 
 } // End of namespace Audio
@@ -24,6 +24,8 @@
 #define AUDIO_RATE_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/mutex.h"
 
 namespace Audio {
 
@@ -75,10 +77,53 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
-	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
+	/**
+	 * Output the samples which are still held back once the input stream
+	 * has ended.
+	 *
+	 * @return Number of sample pairs written into the buffer. Less than
+	 *         osamp once there is nothing left.
+	 */
+	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
+};
+
+/**
+ * Quality of the sample rate conversion. Higher qualities need
+ * considerably more CPU time per sample.
+ */
+enum RateConverterQuality {
+	kRateConverterLinear,     ///< Nearest neighbour or linear interpolation
+	kRateConverterSincMedium, ///< Polyphase windowed sinc filter, 16 taps
+	kRateConverterSincHigh    ///< Polyphase windowed sinc filter, 32 taps
+};
+
+struct SincFilterBank;
+
+/**
+ * Filter banks of the windowed sinc converters, shared by all converters for
+ * the same rates and filter length. The banks are created on first use, and
+ * freed along with the cache.
+ */
+class SincFilterBankCache {
+public:
+	~SincFilterBankCache();
+
+	/** Return the filter bank for the given rates and filter length. */
+	const SincFilterBank *get(st_rate_t inrate, st_rate_t outrate, int taps);
+
+private:
+	Common::Mutex _mutex;
+	Common::Array<SincFilterBank *> _banks;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * Create a RateConverter object for the specified input and output rates.
+ *
+ * @param filterBanks Cache to take the filter banks of sinc converters from.
+ *                    Without one, a sinc converter computes its own bank.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false,
+                                 RateConverterQuality quality = kRateConverterLinear, SincFilterBankCache *filterBanks = nullptr);
 
 } // End of namespace Audio
 
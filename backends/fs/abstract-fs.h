@@ -183,6 +183,15 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Creates a stream which reads the file from a mapping into memory.
+	 * This is only meant for large, read-only game data like resource
+	 * archives.
+	 *
+	 * @return pointer to the stream object, 0 if the file cannot be mapped
+	 */
+	virtual Common::MemoryReadStream *createMappedReadStream() { return nullptr; }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -290,6 +290,16 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return PosixIoStream::makeFromPath(getPath(), false);
 }
 
+Common::MemoryReadStream *POSIXFilesystemNode::createMappedReadStream() {
+#ifdef HAS_MMAP
+	// Large files are read from memory when possible, which avoids the
+	// system calls and copying of stdio.
+	return PosixMmapStream::makeFromPath(getPath());
+#else
+	return nullptr;
+#endif
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return PosixIoStream::makeFromPath(getPath(), true);
 }
@@ -26,6 +26,12 @@
 
 #include <sys/stat.h>
 
+#ifdef HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #if defined(ANDROID_PLAIN_PORT)
 #include "backends/platform/android/jni-android.h"
 #include <unistd.h>
@@ -121,3 +127,36 @@ int32 PosixIoStream::size() const {
 
 	return st.st_size;
 }
+
+#ifdef HAS_MMAP
+PosixMmapStream *PosixMmapStream::makeFromPath(const Common::String &path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return nullptr;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size < kMinMappedSize || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return nullptr;
+	}
+
+	void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after closing the file.
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return nullptr;
+	}
+
+	return new PosixMmapStream(mapping, st.st_size);
+}
+
+PosixMmapStream::PosixMmapStream(void *mapping, uint32 mappingSize) :
+		Common::MemoryReadStream((const byte *)mapping, mappingSize),
+		_mapping(mapping), _mappingSize(mappingSize) {
+}
+
+PosixMmapStream::~PosixMmapStream() {
+	munmap(_mapping, _mappingSize);
+}
+#endif
@@ -25,6 +25,10 @@
 
 #include "backends/fs/stdiostream.h"
 
+#ifdef HAS_MMAP
+#include "common/memstream.h"
+#endif
+
 /**
  * A file input / output stream using POSIX interfaces
  */
@@ -45,4 +49,35 @@ public:
 	int32 size() const override;
 };
 
+#ifdef HAS_MMAP
+/**
+ * A read stream for a file mapped into memory.
+ *
+ * Reading and seeking does not need any system calls. Since accessing the
+ * mapping fails hard if the file is truncated or its medium goes away, this
+ * is only used for files opened through createMappedReadStream().
+ */
+class PosixMmapStream : public Common::MemoryReadStream, public Common::NonCopyable {
+public:
+	/**
+	 * Map the file at the given path into memory.
+	 *
+	 * Only regular files large enough to make mapping them worthwhile are
+	 * mapped. For all other files, and when mapping fails, nullptr is
+	 * returned, and the file should be read with a PosixIoStream instead.
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	PosixMmapStream(void *mapping, uint32 mappingSize);
+	~PosixMmapStream() override;
+
+private:
+	/** Files smaller than this are not worth mapping. */
+	static const uint32 kMinMappedSize = 64 * 1024;
+
+	void *_mapping;
+	uint32 _mappingSize;
+};
+#endif
+
 #endif
@@ -61,6 +61,10 @@
 #ifdef __ANDROID__
 	#include <GLES/gl.h>
 	#define USE_BUILTIN_OPENGL
+	// Not part of OpenGL ES 1.x, only used when the context supports it.
+	#ifndef GL_UNPACK_ROW_LENGTH
+		#define GL_UNPACK_ROW_LENGTH 0x0CF2
+	#endif
 #else
 	#include "backends/graphics/opengl/opengl-defs.h"
 #endif
@@ -118,6 +122,9 @@ struct Context {
 	/** Whether FBO support is available or not. */
 	bool framebufferObjectSupported;
 
+	/** Whether GL_UNPACK_ROW_LENGTH is available or not. */
+	bool unpackSubImageSupported;
+
 #define GL_FUNC_DEF(ret, name, param) ret (GL_CALL_CONV *name)param
 #include "backends/graphics/opengl/opengl-func.h"
 #undef GL_FUNC_DEF
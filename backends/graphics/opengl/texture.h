@@ -28,6 +28,7 @@
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/rect.h"
 
 namespace OpenGL {
@@ -99,6 +100,12 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Query the number of bytes uploaded by updateArea since the last call,
+	 * summed up over all textures.
+	 */
+	static uint32 takeUploadedBytes();
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -143,6 +150,8 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+	static uint32 _uploadedBytes;
 };
 
 /**
@@ -200,8 +209,8 @@ public:
 	 */
 	void fill(uint32 color);
 
-	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	void flagDirty();
+	virtual bool isDirty() const { return !_dirtyAreas.empty(); }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -239,12 +248,30 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	void clearDirty() { _dirtyAreas.clear(); }
 
-	Common::Rect getDirtyArea() const;
+	/**
+	 * Query the areas changed since the last update. They might overlap.
+	 */
+	const Common::Array<Common::Rect> &getDirtyAreas() const { return _dirtyAreas; }
 private:
-	bool _allDirty;
-	Common::Rect _dirtyArea;
+	/**
+	 * Add an area to the dirty areas.
+	 *
+	 * Areas close to each other get merged, as long as that does not add
+	 * much which did not change, so that updates in distant parts of the
+	 * surface do not cause everything in between to be uploaded.
+	 */
+	void addDirtyArea(const Common::Rect &area);
+
+	/**
+	 * Query the number of pixels uploaded to update an area.
+	 */
+	uint getUploadSize(const Common::Rect &area) const;
+
+	static const uint kMaxDirtyAreas = 8;
+
+	Common::Array<Common::Rect> _dirtyAreas;
 };
 
 /**
@@ -262,6 +262,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("mt32_device", "null");
 	ConfMan.registerDefault("gm_device", "null");
 	ConfMan.registerDefault("opl2lpt_parport", "null");
+	ConfMan.registerDefault("audio_predecode", false);
+	ConfMan.registerDefault("video_prefetch_frames", 0);
+	ConfMan.registerDefault("resampling_quality", "linear");
 
 	ConfMan.registerDefault("cdrom", 0);
 
@@ -30,6 +30,7 @@
 #include "common/fs.h"
 #endif
 
+#include "engines/advancedDetector.h"
 #include "engines/detection.h"
 
 // Plugin versioning
@@ -685,6 +686,9 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const
 	// run detection for all of them.
 	plugins = getPlugins(PLUGIN_TYPE_ENGINE_DETECTION);
 
+	// Let the engines share the MD5 sums of the files
+	AdvancedMetaEngineDetection::beginDetectionPass();
+
 	// Iterate over all known games and for each check if it might be
 	// the game in the presented directory.
 	for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
@@ -698,6 +702,8 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const
 		}
 	}
 
+	AdvancedMetaEngineDetection::endDetectionPass();
+
 	return DetectionResults(candidates);
 }
 
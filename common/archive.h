@@ -41,6 +41,7 @@ namespace Common {
  */
 
 class FSNode;
+class MemoryReadStream;
 class SeekableReadStream;
 
 
@@ -137,6 +138,16 @@ public:
 	 * @return The newly created input stream.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Create a stream for the member with the specified name, which reads
+	 * it from a mapping into memory. This is only supported by archives
+	 * of plain files where the file system can map them.
+	 *
+	 * @return The newly created input stream, or 0 if the member does not
+	 *         exist or cannot be mapped.
+	 */
+	virtual MemoryReadStream *createMappedReadStreamForMember(const String &name) const { return nullptr; }
 };
 
 
@@ -263,6 +274,12 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
 
+	/**
+	 * Map the member which createReadStreamForMember() would open, if the
+	 * archive containing it supports that.
+	 */
+	virtual MemoryReadStream *createMappedReadStreamForMember(const String &name) const;
+
 	/**
 	 * Ignore clashes when adding directories. For more details, see the corresponding parameter
 	 * in @ref FSDirectory documentation.
@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic integers
+ * @ingroup common
+ *
+ * @brief Minimal atomic integer type for lock-free communication between threads.
+ * @{
+ */
+
+/**
+ * A 32-bit integer which can be safely read and written from several
+ * threads without holding a mutex.
+ *
+ * All operations are sequentially consistent, i.e. they also act as full
+ * memory barriers for the surrounding non-atomic memory accesses.
+ *
+ * On compilers without atomic builtins, this falls back to a plain
+ * volatile variable, which is only safe on single core systems.
+ */
+template<typename T>
+class Atomic : NonCopyable {
+public:
+	explicit Atomic(T value = 0) : _value(value) {
+		STATIC_ASSERT(sizeof(T) == 4, Atomic_only_supports_32_bit_types);
+	}
+
+	/** Atomically read the current value. */
+	T load() const {
+#if defined(__GNUC__)
+		return __atomic_load_n(&_value, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+		return (T)_InterlockedCompareExchange((volatile long *)&_value, 0, 0);
+#else
+		return _value;
+#endif
+	}
+
+	/** Atomically replace the current value. */
+	void store(T value) {
+#if defined(__GNUC__)
+		__atomic_store_n(&_value, value, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+		_InterlockedExchange((volatile long *)&_value, (long)value);
+#else
+		_value = value;
+#endif
+	}
+
+	/** Atomically add to the current value and return the previous one. */
+	T fetchAdd(T delta) {
+#if defined(__GNUC__)
+		return __atomic_fetch_add(&_value, delta, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+		return (T)_InterlockedExchangeAdd((volatile long *)&_value, (long)delta);
+#else
+		T old = _value;
+		_value = old + delta;
+		return old;
+#endif
+	}
+
+	/**
+	 * Atomically replace the current value by @p desired if it equals
+	 * @p expected.
+	 *
+	 * @return true if the value was replaced.
+	 */
+	bool compareExchange(T expected, T desired) {
+#if defined(__GNUC__)
+		return __atomic_compare_exchange_n(&_value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+		return _InterlockedCompareExchange((volatile long *)&_value, (long)desired, (long)expected) == (long)expected;
+#else
+		if (_value != expected)
+			return false;
+		_value = desired;
+		return true;
+#endif
+	}
+
+private:
+	volatile T _value;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -24,6 +24,7 @@
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/memstream.h"
 #include "common/textconsole.h"
 #include "common/system.h"
 #include "backends/fs/fs-factory.h"
@@ -31,7 +32,7 @@
 namespace Common {
 
 File::File()
-	: _handle(nullptr) {
+	: _handle(nullptr), _mapping(nullptr) {
 }
 
 File::~File() {
@@ -59,6 +60,19 @@ bool File::open(const String &filename, Archive &archive) {
 	return open(stream, filename);
 }
 
+bool File::openMapped(const String &filename) {
+	assert(!filename.empty());
+	assert(!_handle);
+
+	MemoryReadStream *mapping = SearchMan.createMappedReadStreamForMember(filename);
+	if (!mapping)
+		return open(filename);
+
+	debug(8, "Opening mapped: %s", filename.c_str());
+	_mapping = mapping;
+	return open(mapping, filename);
+}
+
 bool File::open(const FSNode &node) {
 	assert(!_handle);
 
@@ -102,12 +116,24 @@ bool File::exists(const String &filename) {
 void File::close() {
 	delete _handle;
 	_handle = nullptr;
+	_mapping = nullptr;
 }
 
 bool File::isOpen() const {
 	return _handle != nullptr;
 }
 
+const byte *File::getMappedRange(uint32 offset, uint32 size) const {
+	if (!_mapping)
+		return nullptr;
+
+	const uint32 fileSize = _mapping->size();
+	if (offset > fileSize || size > fileSize - offset)
+		return nullptr;
+
+	return _mapping->getData() + offset;
+}
+
 bool File::err() const {
 	assert(_handle);
 	return _handle->err();
@@ -41,6 +41,7 @@ namespace Common {
  */
 
 class Archive;
+class MemoryReadStream;
 
 /**
  * @todo vital to document this core class properly!!! For both users and implementors
@@ -53,6 +54,9 @@ protected:
 	/** The name of this file, kept for debugging purposes. */
 	String _name;
 
+	/** The mapping read by _handle if the file was mapped, 0 otherwise. */
+	MemoryReadStream *_mapping;
+
 public:
 	File();
 	virtual ~File();
@@ -107,6 +111,20 @@ public:
 	 */
 	virtual bool open(SeekableReadStream *stream, const String &name);
 
+	/**
+	 * Try to open the file with the given file name like open(), but read
+	 * it from a mapping into memory where the file system supports that.
+	 *
+	 * This is only meant for large, read-only game data like resource
+	 * archives. Files which may change or go away while they are open,
+	 * like savegames, must use open().
+	 * @note Must not be called if this file is already open (i.e. if isOpen returns true).
+	 *
+	 * @param	filename	Name of the file to open.
+	 * @return	True if the file was opened successfully, false otherwise.
+	 */
+	bool openMapped(const String &filename);
+
 	/**
 	 * Close the file, if open.
 	 */
@@ -126,6 +144,18 @@ public:
 	 */
 	const char *getName() const { return _name.c_str(); }
 
+	/**
+	 * Return a pointer to a range of the file, for reading it without
+	 * copying. This only works for files opened with openMapped() which
+	 * could be mapped. The data stays valid until the file is closed.
+	 *
+	 * @param	offset	Position of the range in the file.
+	 * @param	size	Size of the range.
+	 * @return	Pointer to the range, or 0 if the file is not mapped or the
+	 *          range is not within the file.
+	 */
+	const byte *getMappedRange(uint32 offset, uint32 size) const;
+
 	bool err() const override;	/*!< Implement abstract Stream method. */
 	void clearErr() override;	/*!< Implement abstract Stream method. */
 	bool eos() const override;	/*!< Implement abstract SeekableReadStream method. */
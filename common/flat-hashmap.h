@@ -0,0 +1,598 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The open addressing scheme in this file follows the "Swiss table" design
+// of Abseil: the slots are grouped, and one control byte per slot holds
+// seven bits of the hash, so a whole group can be checked for a key at once.
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+#include "common/func.h"
+#include "common/math.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASHMAP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_flat_hashmap Flat hash table (FlatHashMap)
+ * @ingroup common
+ *
+ * @brief Hash table storing its elements inline.
+ *
+ * @{
+ */
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val> which
+ * stores the keys and values directly in its table instead of allocating a
+ * node for each of them.
+ *
+ * Lookups do not need to follow a pointer for every probed slot, and
+ * iterating over the map walks a contiguous array. The price is that
+ * elements are moved around when the table grows, so pointers and
+ * references to values are invalidated by insertions (iterators of
+ * HashMap behave the same way). Erasing never moves elements.
+ *
+ * The requirements on the hash and equality functors are the same as for
+ * HashMap. Since the hash is scrambled internally, even the identity
+ * hashes used for integers work fine.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	struct Node {
+		Val _value;
+		const Key _key;
+		explicit Node(const Key &key) : _value(), _key(key) {}
+	};
+
+	enum {
+		/** Number of slots checked at once, must match the SIMD width */
+		FLATHASHMAP_GROUP_SIZE = 16,
+		FLATHASHMAP_MIN_CAPACITY = FLATHASHMAP_GROUP_SIZE,
+
+		// The table, including erased slots, is filled up to 7/8
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 7,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 8
+	};
+
+	// Control byte values. Used slots hold the top seven bits of the hash,
+	// so all special values have the sign bit set.
+	enum {
+		kCtrlEmpty = -128,
+		kCtrlDeleted = -2
+	};
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	int8 *_ctrl;		///< one control byte per slot
+	Node *_slots;		///< raw storage, only used slots contain constructed nodes
+	size_type _mask;	///< Capacity of the FlatHashMap minus one; capacity is a power of two
+	size_type _size;
+	size_type _deleted;	///< Number of slots marked as kCtrlDeleted
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	static uint32 mixHash(size_type hash) {
+		// Fibonacci hashing, so that the control byte (taken from the top
+		// bits) and the group index (taken from the bottom bits) depend on
+		// all bits of the hash
+		const uint32 mixed = (uint32)hash * 0x9E3779B1U;
+		return mixed ^ (mixed >> 16);
+	}
+
+	static int8 controlByte(uint32 hash) {
+		return (int8)(hash >> 25);
+	}
+
+	/** Return a bit mask of the slots in the group whose control byte is @p value. */
+	static uint32 matchGroup(const int8 *group, int8 value) {
+#ifdef FLAT_HASHMAP_USE_SSE2
+		const __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+		return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+#else
+		uint32 mask = 0;
+		for (int i = 0; i < FLATHASHMAP_GROUP_SIZE; ++i) {
+			if (group[i] == value)
+				mask |= 1 << i;
+		}
+		return mask;
+#endif
+	}
+
+	/** Return a bit mask of the empty or deleted slots in the group. */
+	static uint32 matchFree(const int8 *group) {
+#ifdef FLAT_HASHMAP_USE_SSE2
+		return (uint32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+		uint32 mask = 0;
+		for (int i = 0; i < FLATHASHMAP_GROUP_SIZE; ++i) {
+			if (group[i] < 0)
+				mask |= 1 << i;
+		}
+		return mask;
+#endif
+	}
+
+	bool isUsed(size_type idx) const {
+		return _ctrl[idx] >= 0;
+	}
+
+	void allocate(size_type capacity) {
+		_mask = capacity - 1;
+		_ctrl = new int8[capacity];
+		memset(_ctrl, kCtrlEmpty, capacity);
+		_slots = (Node *)malloc(capacity * sizeof(Node));
+		assert(_slots != nullptr);
+		_size = 0;
+		_deleted = 0;
+	}
+
+	void destroyNodes() {
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (isUsed(ctr))
+				_slots[ctr].~Node();
+		}
+	}
+
+	void deallocate() {
+		delete[] _ctrl;
+		free(_slots);
+	}
+
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key, uint32 hash) const;
+	size_type findFreeSlot(uint32 hash) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void eraseSlot(size_type ctr);
+	void rehash(size_type newCapacity);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->isUsed(_idx));
+			return &_hashmap->_slots[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			_idx = _hashmap->nextUsed(_idx + 1);
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+	/** Return the first used slot starting at @p idx, or (size_type)-1. */
+	size_type nextUsed(size_type idx) const {
+		for (; idx <= _mask; ++idx) {
+			if (isUsed(idx))
+				return idx;
+		}
+		return (size_type)-1;
+	}
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		destroyNodes();
+		deallocate();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	bool tryGetVal(const Key &key, Val &out) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		return iterator(nextUsed(0), this);
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		return const_iterator(nextUsed(0), this);
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		return iterator(lookup(key, mixHash(_hash(key))), this);
+	}
+
+	const_iterator	find(const Key &key) const {
+		return const_iterator(lookup(key, mixHash(_hash(key))), this);
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocate(FLATHASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	destroyNodes();
+	deallocate();
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one. Since both use the same hash, the elements keep their slots.
+ *
+ * @note The previous storage here is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocate(map._mask + 1);
+	memcpy(_ctrl, map._ctrl, _mask + 1);
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isUsed(ctr))
+			new ((void *)&_slots[ctr]) Node(map._slots[ctr]);
+	}
+
+	_size = map._size;
+	_deleted = map._deleted;
+}
+
+/**
+ * Clear all values in the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	destroyNodes();
+
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		deallocate();
+		allocate(FLATHASHMAP_MIN_CAPACITY);
+	} else {
+		memset(_ctrl, kCtrlEmpty, _mask + 1);
+		_size = 0;
+		_deleted = 0;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(size_type newCapacity) {
+	const size_type oldMask = _mask;
+	int8 *oldCtrl = _ctrl;
+	Node *oldSlots = _slots;
+#ifndef NDEBUG
+	const size_type oldSize = _size;
+#endif
+
+	allocate(newCapacity);
+
+	// Since we know that no key exists twice in the old table, we don't
+	// have to compare any keys while inserting
+	for (size_type ctr = 0; ctr <= oldMask; ++ctr) {
+		if (oldCtrl[ctr] < 0)
+			continue;
+
+		const uint32 hash = mixHash(_hash(oldSlots[ctr]._key));
+		const size_type idx = findFreeSlot(hash);
+		_ctrl[idx] = controlByte(hash);
+		new ((void *)&_slots[idx]) Node(oldSlots[ctr]);
+		oldSlots[ctr].~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == oldSize);
+
+	delete[] oldCtrl;
+	free(oldSlots);
+}
+
+/**
+ * Internal method returning the slot containing @p key, or (size_type)-1.
+ *
+ * The groups are probed in triangular order, which visits every group of a
+ * table with a power of two number of groups. The search stops at a group
+ * with an empty slot, since the key would have been put there.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key, uint32 hash) const {
+	const int8 ctrlByte = controlByte(hash);
+	const size_type groupMask = _mask / FLATHASHMAP_GROUP_SIZE;
+	size_type group = hash & groupMask;
+
+	for (size_type step = 1; ; ++step) {
+		const int8 *ctrl = _ctrl + group * FLATHASHMAP_GROUP_SIZE;
+
+		for (uint32 match = matchGroup(ctrl, ctrlByte); match; ) {
+			const int bit = intLog2(match);
+			const size_type idx = group * FLATHASHMAP_GROUP_SIZE + bit;
+			if (_equal(_slots[idx]._key, key))
+				return idx;
+			match &= ~(1U << bit);
+		}
+
+		if (matchGroup(ctrl, kCtrlEmpty))
+			return (size_type)-1;
+
+		group = (group + step) & groupMask;
+	}
+}
+
+/**
+ * Internal method returning the first empty or deleted slot on the probe
+ * sequence of @p hash.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::findFreeSlot(uint32 hash) const {
+	const size_type groupMask = _mask / FLATHASHMAP_GROUP_SIZE;
+	size_type group = hash & groupMask;
+
+	for (size_type step = 1; ; ++step) {
+		const uint32 freeSlots = matchFree(_ctrl + group * FLATHASHMAP_GROUP_SIZE);
+		if (freeSlots)
+			return group * FLATHASHMAP_GROUP_SIZE + intLog2(freeSlots);
+
+		group = (group + step) & groupMask;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const uint32 hash = mixHash(_hash(key));
+	size_type ctr = lookup(key, hash);
+	if (ctr != (size_type)-1)
+		return ctr;
+
+	// Keep the load factor below a certain threshold. Deleted slots are
+	// also counted, as they lengthen the probe sequences just the same.
+	// If most of the load comes from them, rehash without growing.
+	size_type capacity = _mask + 1;
+	if ((_size + _deleted + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		if ((_size + 1) * 2 * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+			capacity *= 2;
+		rehash(capacity);
+	}
+
+	ctr = findFreeSlot(hash);
+	if (_ctrl[ctr] == kCtrlDeleted)
+		_deleted--;
+	_ctrl[ctr] = controlByte(hash);
+	new ((void *)&_slots[ctr]) Node(key);
+	_size++;
+
+	return ctr;
+}
+
+/**
+ * Check whether the hashmap contains the given key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key, mixHash(_hash(key))) != (size_type)-1;
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	// Inserting may reallocate _slots, so look up the index first
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._value;
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+/**
+ * Get a value from the hashmap. If the key is not present, then return @p defaultVal.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	const size_type ctr = lookup(key, mixHash(_hash(key)));
+	if (ctr != (size_type)-1)
+		return _slots[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::tryGetVal(const Key &key, Val &out) const {
+	const size_type ctr = lookup(key, mixHash(_hash(key)));
+	if (ctr != (size_type)-1) {
+		out = _slots[ctr]._value;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Assign an element specified by @p key to a value @p val.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._value = val;
+}
+
+/**
+ * Internal method to remove the element in slot @p ctr.
+ *
+ * A group which still has an empty slot was never full, so no probe
+ * sequence continues past it, and the slot can become empty again.
+ * Otherwise it has to be marked as deleted.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type ctr) {
+	_slots[ctr].~Node();
+
+	if (matchGroup(_ctrl + (ctr & ~(size_type)(FLATHASHMAP_GROUP_SIZE - 1)), kCtrlEmpty)) {
+		_ctrl[ctr] = kCtrlEmpty;
+	} else {
+		_ctrl[ctr] = kCtrlDeleted;
+		_deleted++;
+	}
+	_size--;
+}
+
+/**
+ * Erase an element referred to by an iterator.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	assert(entry._idx <= _mask);
+	assert(isUsed(entry._idx));
+
+	eraseSlot(entry._idx);
+}
+
+/**
+ * Erase an element specified by a key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	const size_type ctr = lookup(key, mixHash(_hash(key)));
+	if (ctr != (size_type)-1)
+		eraseSlot(ctr);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -44,6 +44,7 @@ namespace Common {
  */
 
 class FSNode;
+class MemoryReadStream;
 class SeekableReadStream;
 class WriteStream;
 
@@ -231,6 +232,19 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Create a stream which reads the file from a mapping into memory,
+	 * where the file system supports that. Otherwise, the file should be
+	 * read with createReadStream() instead.
+	 *
+	 * This is only meant for large, read-only game data like resource
+	 * archives. Files which may change or go away while they are open,
+	 * like savegames, must use createReadStream().
+	 *
+	 * @return Pointer to the stream object, 0 if the file cannot be mapped.
+	 */
+	MemoryReadStream *createMappedReadStream() const;
+
 	/**
 	 * Create a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -392,6 +406,11 @@ public:
 	 * for success.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * Map the specified file into memory, if the file system supports it.
+	 */
+	virtual MemoryReadStream *createMappedReadStreamForMember(const String &name) const;
 };
 
 /** @} */
@@ -0,0 +1,128 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_LOCKFREE_QUEUE_H
+#define COMMON_LOCKFREE_QUEUE_H
+
+#include "common/scummsys.h"
+#include "common/atomic.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_lockfree_queue Lock-free queue
+ * @ingroup common
+ *
+ * @brief Fixed size ring buffer for passing data between two threads.
+ * @{
+ */
+
+/**
+ * A bounded FIFO queue which can be used by exactly one producer thread
+ * and one consumer thread at the same time without any locking.
+ *
+ * If several threads need to push (or pop), they have to serialize
+ * their accesses among themselves, e.g. with a Common::Mutex. Neither
+ * push() nor pop() ever block, which makes this suitable for handing
+ * data to or from realtime code such as the audio mixer callback.
+ */
+template<class T>
+class LockFreeQueue : NonCopyable {
+public:
+	/**
+	 * Create a queue which can hold at least @p capacity elements. The
+	 * capacity is rounded up to the next power of two.
+	 */
+	explicit LockFreeQueue(uint32 capacity) : _capacity(1), _head(0), _tail(0) {
+		while (_capacity < capacity)
+			_capacity <<= 1;
+		_storage = new T[_capacity];
+	}
+
+	~LockFreeQueue() {
+		delete[] _storage;
+	}
+
+	/** Return the maximal number of elements the queue can hold. */
+	uint32 capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * Return the number of queued elements. When called while the other
+	 * thread is active, the result may already be outdated on return.
+	 */
+	uint32 size() const {
+		return _tail.load() - _head.load();
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	/**
+	 * Append an element. May only be called from the producer thread.
+	 *
+	 * @return false if the queue is full.
+	 */
+	bool push(const T &item) {
+		const uint32 tail = _tail.load();
+		if (tail - _head.load() == _capacity)
+			return false;
+
+		_storage[tail & (_capacity - 1)] = item;
+		_tail.store(tail + 1);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest element. May only be called from the consumer
+	 * thread.
+	 *
+	 * @return false if the queue is empty.
+	 */
+	bool pop(T &item) {
+		const uint32 head = _head.load();
+		if (head == _tail.load())
+			return false;
+
+		item = _storage[head & (_capacity - 1)];
+		_head.store(head + 1);
+		return true;
+	}
+
+private:
+	T *_storage;
+	uint32 _capacity;
+
+	/** Index of the next element to pop, only written by the consumer */
+	Atomic<uint32> _head;
+	/** Index of the next element to push, only written by the producer */
+	Atomic<uint32> _tail;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
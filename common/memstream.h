@@ -79,6 +79,12 @@ public:
 	int32 size() const { return _size; }
 
 	bool seek(int32 offs, int whence = SEEK_SET);
+
+	/**
+	 * Return a pointer to all the data of the stream, for reading it without
+	 * copying. The data stays valid as long as the stream exists.
+	 */
+	const byte *getData() const { return _ptrOrig; }
 };
 
 
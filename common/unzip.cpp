@@ -106,6 +106,9 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/bufferedstream.h"
+#include "common/ptr.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -1125,6 +1128,28 @@ int unzOpenCurrentFile (unzFile file) {
 }
 
 
+/*
+  Give the position of the data of the current file in the zipfile, after
+  checking its local header, without opening the file.
+*/
+static int unzlocal_GetCurrentFileDataOffset(unz_s* s, uLong *poffset) {
+	uInt iSizeVar;
+	uLong offset_local_extrafield;
+	uInt  size_local_extrafield;
+
+	if (!s->current_file_ok)
+		return UNZ_PARAMERROR;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s,&iSizeVar,
+				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
+		return UNZ_BADZIPFILE;
+
+	*poffset = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar +
+		s->byte_before_the_zipfile;
+	return UNZ_OK;
+}
+
+
 /*
   Read bytes from the current file.
   buf contain buffer where data must be copied
@@ -1420,11 +1445,322 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 namespace Common {
 
 
+/**
+ * A read stream for a member of a zip archive, which decompresses the
+ * member while it is read instead of all at once.
+ *
+ * To keep seeking backward cheap, the state of the decompression gets saved
+ * at checkpoints about every kCheckpointSpacing bytes of the member, from
+ * which decompression can restart instead of from the start of the member.
+ *
+ * Each member stream reads the archive through its own handle, so that it
+ * can be used from any thread, also after the archive is gone.
+ */
+class ZipMemberReadStream : public SeekableReadStream {
+public:
+	ZipMemberReadStream(SeekableReadStream *zipStream, uint32 dataOffset,
+	                    uint32 compressedSize, uint32 uncompressedSize, uint32 crc, bool deflated);
+	~ZipMemberReadStream() override;
+
+	bool err() const override { return _err; }
+	void clearErr() override;
+	bool eos() const override { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+
+	int32 pos() const override { return _pos; }
+	int32 size() const override { return _uncompressedSize; }
+	bool seek(int32 offset, int whence = SEEK_SET) override;
+
+private:
+	enum {
+		kInputBufferSize = 16384,
+		kWindowSize = 32768,
+		kCheckpointSpacing = 1024 * 1024
+	};
+
+	struct Checkpoint {
+		uint32 outputPos;
+		uint32 inputPos;
+		int bits;
+		uint windowSize;
+		byte window[kWindowSize];
+	};
+
+	uint32 readStored(byte *dst, uint32 dataSize);
+	void updateCrc(const byte *data, uint32 dataSize);
+
+#ifdef USE_ZLIB
+	uint32 inflateData(byte *dst, uint32 dataSize);
+	void addCheckpoint(uint32 outputPos);
+	bool restart(uint32 targetPos);
+#endif
+
+	ScopedPtr<SeekableReadStream> _zipStream;
+	const uint32 _dataOffset;
+	const uint32 _compressedSize;
+	const uint32 _uncompressedSize;
+	const uint32 _crc;
+	const bool _deflated;
+
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+	/** Position up to which the data has been checked against the CRC. */
+	uint32 _crcPos;
+	uint32 _crcData;
+
+#ifdef USE_ZLIB
+	z_stream _stream;
+	/** Amount of compressed data read into the input buffer so far. */
+	uint32 _inputPos;
+	byte _inputBuffer[kInputBufferSize];
+
+	Array<Checkpoint *> _checkpoints;
+#endif
+};
+
+ZipMemberReadStream::ZipMemberReadStream(SeekableReadStream *zipStream, uint32 dataOffset,
+                                         uint32 compressedSize, uint32 uncompressedSize, uint32 crc, bool deflated)
+	: _zipStream(zipStream), _dataOffset(dataOffset), _compressedSize(compressedSize),
+	  _uncompressedSize(uncompressedSize), _crc(crc), _deflated(deflated),
+	  _pos(0), _eos(false), _err(false), _crcPos(0), _crcData(0) {
+#ifdef USE_ZLIB
+	_inputPos = 0;
+	memset(&_stream, 0, sizeof(_stream));
+	if (_deflated)
+		_err = (inflateInit2(&_stream, -MAX_WBITS) != Z_OK);
+#else
+	// Cannot decompress the member without zlib.
+	_err = _deflated;
+#endif
+}
+
+ZipMemberReadStream::~ZipMemberReadStream() {
+#ifdef USE_ZLIB
+	if (_deflated)
+		inflateEnd(&_stream);
+	for (uint i = 0; i < _checkpoints.size(); ++i)
+		delete _checkpoints[i];
+#endif
+}
+
+void ZipMemberReadStream::clearErr() {
+	_eos = false;
+	if (!_err)
+		return;
+
+	// The decompression state is undefined after an error, so start over
+	// and skip back to the current position.
+	_err = false;
+	_zipStream->clearErr();
+#ifdef USE_ZLIB
+	if (_deflated) {
+		const uint32 pos = _pos;
+		_err = (inflateReset(&_stream) != Z_OK);
+		_stream.avail_in = 0;
+		_inputPos = 0;
+		_pos = 0;
+		if (!_err)
+			seek(pos);
+	}
+#else
+	_err = _deflated;
+#endif
+}
+
+uint32 ZipMemberReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (_err)
+		return 0;
+
+	if (dataSize > _uncompressedSize - _pos) {
+		dataSize = _uncompressedSize - _pos;
+		_eos = true;
+	}
+
+	byte *dst = (byte *)dataPtr;
+	uint32 total = 0;
+	while (total < dataSize) {
+#ifdef USE_ZLIB
+		const uint32 count = _deflated ? inflateData(dst + total, dataSize - total) : readStored(dst + total, dataSize - total);
+#else
+		const uint32 count = readStored(dst + total, dataSize - total);
+#endif
+		if (count == 0) {
+			_err = true;
+			break;
+		}
+
+		updateCrc(dst + total, count);
+		_pos += count;
+		total += count;
+	}
+
+	return total;
+}
+
+bool ZipMemberReadStream::seek(int32 offset, int whence) {
+	int32 newPos;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _uncompressedSize + offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	}
+
+	if (newPos < 0 || (uint32)newPos > _uncompressedSize || _err)
+		return false;
+
+	_eos = false;
+	if (!_deflated) {
+		_pos = newPos;
+		return true;
+	}
+
+#ifdef USE_ZLIB
+	// Go back to the closest checkpoint before the new position, unless
+	// the current position is closer.
+	if (!restart(newPos))
+		return false;
+
+	byte skipBuffer[4096];
+	while ((uint32)newPos > _pos) {
+		const uint32 count = MIN<uint32>(newPos - _pos, sizeof(skipBuffer));
+		if (read(skipBuffer, count) != count)
+			return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint32 ZipMemberReadStream::readStored(byte *dst, uint32 dataSize) {
+	if (!_zipStream->seek(_dataOffset + _pos, SEEK_SET))
+		return 0;
+	return _zipStream->read(dst, dataSize);
+}
+
+void ZipMemberReadStream::updateCrc(const byte *data, uint32 dataSize) {
+#ifdef USE_ZLIB
+	// The CRC can only be checked for data read in order. Anything read
+	// again after seeking backward has been checked already.
+	if (_pos > _crcPos || _pos + dataSize <= _crcPos)
+		return;
+
+	const uint32 skip = _crcPos - _pos;
+	_crcData = crc32(_crcData, data + skip, dataSize - skip);
+	_crcPos += dataSize - skip;
+
+	if (_crcPos == _uncompressedSize && _crcData != _crc) {
+		warning("ZipMemberReadStream: CRC mismatch");
+		_err = true;
+	}
+#endif  // otherwise the CRC can't be verified
+}
+
+#ifdef USE_ZLIB
+uint32 ZipMemberReadStream::inflateData(byte *dst, uint32 dataSize) {
+	_stream.next_out = dst;
+	_stream.avail_out = dataSize;
+
+	while (_stream.avail_out > 0) {
+		if (_stream.avail_in == 0) {
+			const uint32 count = MIN<uint32>(_compressedSize - _inputPos, kInputBufferSize);
+			if (count == 0 || !_zipStream->seek(_dataOffset + _inputPos, SEEK_SET) ||
+			    _zipStream->read(_inputBuffer, count) != count)
+				break;
+
+			_inputPos += count;
+			_stream.next_in = _inputBuffer;
+			_stream.avail_in = count;
+		}
+
+		// Stop at the end of each block, which are the only places
+		// decompression can restart from.
+		const int result = inflate(&_stream, Z_BLOCK);
+		if (result != Z_OK)
+			break;
+
+		const uint32 outputPos = _pos + dataSize - _stream.avail_out;
+		const bool blockEnd = (_stream.data_type & 128) && !(_stream.data_type & 64);
+		const uint32 nextCheckpoint = (_checkpoints.size() + 1) * kCheckpointSpacing;
+		if (blockEnd && outputPos >= nextCheckpoint && outputPos < _uncompressedSize)
+			addCheckpoint(outputPos);
+	}
+
+	return dataSize - _stream.avail_out;
+}
+
+void ZipMemberReadStream::addCheckpoint(uint32 outputPos) {
+#if ZLIB_VERNUM >= 0x1280
+	// The window of the previous data is needed to restart decompression,
+	// which only newer versions of zlib can provide.
+	Checkpoint *checkpoint = new Checkpoint();
+	checkpoint->outputPos = outputPos;
+	checkpoint->inputPos = _inputPos - _stream.avail_in;
+	checkpoint->bits = _stream.data_type & 7;
+	uInt windowSize = kWindowSize;
+	if (inflateGetDictionary(&_stream, checkpoint->window, &windowSize) != Z_OK) {
+		delete checkpoint;
+		return;
+	}
+	checkpoint->windowSize = windowSize;
+	_checkpoints.push_back(checkpoint);
+#endif
+}
+
+bool ZipMemberReadStream::restart(uint32 targetPos) {
+	const Checkpoint *checkpoint = nullptr;
+	for (uint i = 0; i < _checkpoints.size() && _checkpoints[i]->outputPos <= targetPos; ++i)
+		checkpoint = _checkpoints[i];
+
+	if (targetPos >= _pos && (!checkpoint || checkpoint->outputPos <= _pos))
+		return true;
+
+	if (inflateReset(&_stream) != Z_OK) {
+		_err = true;
+		return false;
+	}
+	_stream.avail_in = 0;
+
+	if (!checkpoint) {
+		_inputPos = 0;
+		_pos = 0;
+		return true;
+	}
+
+	// A block might end in the middle of a byte. Its remaining bits are
+	// the start of the next block.
+	_inputPos = checkpoint->inputPos;
+	if (checkpoint->bits) {
+		_zipStream->seek(_dataOffset + _inputPos - 1, SEEK_SET);
+		const byte partial = _zipStream->readByte();
+		inflatePrime(&_stream, checkpoint->bits, partial >> (8 - checkpoint->bits));
+	}
+
+	if (_zipStream->err() || inflateSetDictionary(&_stream, checkpoint->window, checkpoint->windowSize) != Z_OK) {
+		_err = true;
+		return false;
+	}
+
+	_pos = checkpoint->outputPos;
+	return true;
+}
+#endif
+
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
 public:
-	ZipArchive(unzFile zipFile);
+	ZipArchive(unzFile zipFile, const ArchiveMemberPtr &source);
 
 
 	~ZipArchive();
@@ -1433,6 +1769,13 @@ public:
 	virtual int listMembers(ArchiveMemberList &list) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+private:
+	/** Members smaller than this are decompressed all at once. */
+	static const uint32 kMinStreamedMemberSize = 256 * 1024;
+
+	/** Where the archive came from, to open a handle for each streamed member. */
+	ArchiveMemberPtr _source;
 };
 
 /*
@@ -1453,7 +1796,7 @@ public:
 };
 */
 
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+ZipArchive::ZipArchive(unzFile zipFile, const ArchiveMemberPtr &source) : _zipFile(zipFile), _source(source) {
 	assert(_zipFile);
 }
 
@@ -1490,10 +1833,38 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 		return nullptr;
 
 	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
 		return nullptr;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+	if (fileInfo.compression_method != 0 && fileInfo.compression_method != Z_DEFLATED)
+		return nullptr;
+
+	// Large members are decompressed while they are read, so that they do
+	// not need to be in memory all at once. This needs a separate handle of
+	// the archive, since the member may be read from another thread.
+	SeekableReadStream *zipStream = nullptr;
+	if (fileInfo.uncompressed_size >= kMinStreamedMemberSize && _source)
+		zipStream = _source->createReadStream();
+
+	if (zipStream) {
+		unz_s *archive = (unz_s *)_zipFile;
+		uLong dataOffset;
+		if (unzlocal_GetCurrentFileDataOffset(archive, &dataOffset) != UNZ_OK) {
+			delete zipStream;
+			return nullptr;
+		}
+
+		SeekableReadStream *stream = new ZipMemberReadStream(zipStream, dataOffset,
+			fileInfo.compressed_size, fileInfo.uncompressed_size, fileInfo.crc, fileInfo.compression_method == Z_DEFLATED);
+		if (stream->err()) {
+			delete stream;
+			return nullptr;
+		}
+
+		return wrapBufferedSeekableReadStream(stream, 4096, DisposeAfterUse::YES);
+	}
+
+	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
 		return nullptr;
 
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
@@ -1510,22 +1881,9 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
-}
-
-Archive *makeZipArchive(const String &name) {
-	return makeZipArchive(SearchMan.createReadStreamForMember(name));
 }
 
-Archive *makeZipArchive(const FSNode &node) {
-	return makeZipArchive(node.createReadStream());
-}
-
-Archive *makeZipArchive(SeekableReadStream *stream) {
+static Archive *makeZipArchive(SeekableReadStream *stream, const ArchiveMemberPtr &source) {
 	if (!stream)
 		return nullptr;
 	unzFile zipFile = unzOpen(stream);
@@ -1534,7 +1892,29 @@ Archive *makeZipArchive(SeekableReadStream *stream) {
 		// goes wrong.
 		return nullptr;
 	}
-	return new ZipArchive(zipFile);
+	return new ZipArchive(zipFile, source);
+}
+
+Archive *makeZipArchive(const String &name) {
+	return makeZipArchive(SearchMan.getMember(name));
+}
+
+Archive *makeZipArchive(const FSNode &node) {
+	// The central directory and small members are read from a mapping
+	SeekableReadStream *stream = node.createMappedReadStream();
+	if (!stream)
+		stream = node.createReadStream();
+	return makeZipArchive(stream, ArchiveMemberPtr(new FSNode(node)));
+}
+
+Archive *makeZipArchive(const ArchiveMemberPtr &member) {
+	if (!member)
+		return nullptr;
+	return makeZipArchive(member->createReadStream(), member);
+}
+
+Archive *makeZipArchive(SeekableReadStream *stream) {
+	return makeZipArchive(stream, ArchiveMemberPtr());
 }
 
 } // End of namespace Common
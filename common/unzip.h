@@ -23,6 +23,7 @@
 #ifndef COMMON_UNZIP_H
 #define COMMON_UNZIP_H
 
+#include "common/archive.h"
 #include "common/str.h"
 
 namespace Common {
@@ -36,9 +37,7 @@ namespace Common {
  * @{
  */
 
-class Archive;
 class FSNode;
-class SeekableReadStream;
 
 /**
  * This factory method creates an Archive instance corresponding to the content
@@ -56,6 +55,15 @@ Archive *makeZipArchive(const String &name);
  */
 Archive *makeZipArchive(const FSNode &node);
 
+/**
+ * This factory method creates an Archive instance corresponding to the content
+ * of the given ZIP compressed archive member. Large members of the archive get
+ * their own read stream of the member, so that they can be read from any thread.
+ *
+ * May return 0 in case of a failure.
+ */
+Archive *makeZipArchive(const ArchiveMemberPtr &member);
+
 /**
  * This factory method creates an Archive instance corresponding to the content
  * of the given ZIP compressed datastream.
@@ -447,39 +447,62 @@ void AdvancedMetaEngineDetection::composeFileHashMap(FileMap &allFiles, const Co
 	}
 }
 
-bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
-	// FIXME/TODO: We don't handle the case that a file is listed as a regular
-	// file and as one with resource fork.
-
-	if (game.flags & ADGF_MACRESFORK) {
-		FileMapArchive fileMapArchive(allFiles);
-
-		Common::MacResManager macResMan;
+typedef Common::HashMap<Common::String, FileProperties> MD5Cache;
 
-		if (!macResMan.open(fname, fileMapArchive))
-			return false;
+/**
+ * MD5 sums computed during the current detection pass, indexed by the
+ * number of hashed bytes and the path of the file.
+ *
+ * Each engine checks the files it knows about on its own, so different
+ * engines often hash the same file of a directory. The cache only lives as
+ * long as a pass, so files changed in between get hashed again. The file
+ * size is still compared on every lookup.
+ */
+static MD5Cache &getMD5Cache() {
+	static MD5Cache cache;
+	return cache;
+}
 
-		fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
-		fileProps.size = macResMan.getResForkDataSize();
+/** Number of detection passes in progress; the cache is only used while positive */
+static int s_detectionPasses = 0;
 
-		if (fileProps.size != 0)
-			return true;
-	}
+void AdvancedMetaEngineDetection::beginDetectionPass() {
+	s_detectionPasses++;
+}
 
-	if (!allFiles.contains(fname))
-		return false;
+void AdvancedMetaEngineDetection::endDetectionPass() {
+	assert(s_detectionPasses > 0);
+	if (--s_detectionPasses == 0)
+		getMD5Cache().clear(true);
+}
 
+static bool getDataForkProperties(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps) {
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+
+	if (!s_detectionPasses) {
+		fileProps.md5 = Common::computeStreamMD5AsString(testFile, md5Bytes);
+		return true;
+	}
+
+	const Common::String key = Common::String::format("%u:%s", md5Bytes, node.getPath().c_str());
+	MD5Cache &cache = getMD5Cache();
+	MD5Cache::const_iterator cached = cache.find(key);
+	if (cached != cache.end() && cached->_value.size == fileProps.size) {
+		fileProps.md5 = cached->_value.md5;
+		return true;
+	}
+
+	fileProps.md5 = Common::computeStreamMD5AsString(testFile, md5Bytes);
+	cache[key] = fileProps;
 	return true;
 }
 
-bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
+static bool getFilePropertiesImpl(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, const ADGameDescription &game, const Common::String &fname, FileProperties &fileProps) {
 	// FIXME/TODO: We don't handle the case that a file is listed as a regular
 	// file and as one with resource fork.
 
@@ -501,14 +524,15 @@ bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &a
 	if (!allFiles.contains(fname))
 		return false;
 
-	Common::File testFile;
+	return getDataForkProperties(allFiles[fname], md5Bytes, fileProps);
+}
 
-	if (!testFile.open(allFiles[fname]))
-		return false;
+bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
+	return getFilePropertiesImpl(_md5Bytes, allFiles, game, fname, fileProps);
+}
 
-	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, md5Bytes);
-	return true;
+bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
+	return getFilePropertiesImpl(md5Bytes, allFiles, game, fname, fileProps);
 }
 
 ADDetectedGames AdvancedMetaEngineDetection::detectGame(const Common::FSNode &parent, const FileMap &allFiles, Common::Language language, Common::Platform platform, const Common::String &extra) const {
@@ -266,6 +266,20 @@ public:
 
 	DetectedGames detectGames(const Common::FSList &fslist) const override;
 
+	/**
+	 * Start a detection pass of all engines over the files of a single
+	 * directory. Until the matching endDetectionPass() call, the MD5 sums
+	 * computed by the advanced detector engines are shared, so that several
+	 * engines checking the same file only hash it once.
+	 *
+	 * Nothing is kept beyond the pass: detecting the same directory again
+	 * hashes its files again.
+	 */
+	static void beginDetectionPass();
+
+	/** End a detection pass, and forget the MD5 sums cached during it. */
+	static void endDetectionPass();
+
 	/**
 	 * A generic createInstance.
 	 * For instantiating engine objects, this method is called first,
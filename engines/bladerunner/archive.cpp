@@ -23,6 +23,7 @@
 #include "bladerunner/archive.h"
 
 #include "common/debug.h"
+#include "common/memstream.h"
 
 namespace BladeRunner {
 
@@ -43,7 +44,7 @@ bool MIXArchive::exists(const Common::String &filename) {
 }
 
 bool MIXArchive::open(const Common::String &filename) {
-	if (!_fd.open(filename)) {
+	if (!_fd.openMapped(filename)) {
 		error("MIXArchive::open(): Can not open %s", filename.c_str());
 		return false;
 	}
@@ -159,6 +160,12 @@ Common::SeekableReadStream *MIXArchive::createReadStreamForMember(const Common::
 	uint32 start = _entries[i].offset + 6 + 12 * _entryCount;
 	uint32 end   = _entries[i].length + start;
 
+	// Read mapped archives in place, without sharing the file position
+	const byte *data = _fd.getMappedRange(start, _entries[i].length);
+	if (data) {
+		return new Common::MemoryReadStream(data, _entries[i].length);
+	}
+
 	return new Common::SafeSeekableSubReadStream(&_fd, start, end, DisposeAfterUse::NO);
 }
 
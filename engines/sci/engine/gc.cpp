@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -181,6 +182,8 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 
 void run_gc(EngineState *s) {
 	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+	uint32 freed = 0;
 
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
@@ -193,6 +196,7 @@ void run_gc(EngineState *s) {
 
 	// Compute the set of all segments references currently in use.
 	AddrSet *activeRefs = findAllActiveReferences(s);
+	const uint32 markEndTime = g_system->getMillis();
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -215,6 +219,7 @@ void run_gc(EngineState *s) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -224,8 +229,21 @@ void run_gc(EngineState *s) {
 		}
 	}
 
+	GCStatistics &stats = s->gcStatistics;
+	const uint32 endTime = g_system->getMillis();
+	stats.collections++;
+	stats.lastMarkTime = markEndTime - startTime;
+	stats.lastSweepTime = endTime - markEndTime;
+	stats.lastReachable = activeRefs->size();
+	stats.lastFreed = freed;
+	stats.totalTime += endTime - startTime;
+	stats.maxTime = MAX(stats.maxTime, endTime - startTime);
+
 	delete activeRefs;
 
+	debugC(kDebugLevelGC, "[GC] Collection %d took %d ms (mark %d ms, sweep %d ms), %d reachable, %d freed",
+		stats.collections, endTime - startTime, stats.lastMarkTime, stats.lastSweepTime, stats.lastReachable, freed);
+
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -112,6 +112,7 @@ void playVideo(Video::VideoDecoder &videoDecoder) {
 		if (g_sci->getEngineState()->_delayedRestoreGameId != -1)
 			skipVideo = true;
 
+		videoDecoder.decodeAhead();
 		g_system->delayMillis(10);
 	}
 }
@@ -73,6 +73,30 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_instructionCache.clear();
+}
+
+int Script::decodeInstruction(uint32 offset, byte &extOpcode, int16 opparams[4]) const {
+	if (_instructionCache.empty()) {
+		DecodedInstruction unused;
+		unused.offset = kNoRelocation;
+		_instructionCache.resize(kInstructionCacheSize);
+		for (uint i = 0; i < kInstructionCacheSize; ++i)
+			_instructionCache[i] = unused;
+	}
+
+	// The code is never modified after loading, patches are applied right
+	// away, so entries stay valid until the script gets freed
+	DecodedInstruction &entry = _instructionCache[offset & (kInstructionCacheSize - 1)];
+	if (entry.offset != offset) {
+		entry.size = readPMachineInstruction(getBuf(offset), entry.extOpcode, entry.opparams);
+		entry.offset = offset;
+	}
+
+	extOpcode = entry.extOpcode;
+	memcpy(opparams, entry.opparams, sizeof(entry.opparams));
+	return entry.size;
 }
 
 enum {
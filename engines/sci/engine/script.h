@@ -69,6 +69,14 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/** A VM instruction as returned by readPMachineInstruction() */
+struct DecodedInstruction {
+	uint32 offset;      ///< offset of the instruction in the script buffer, or kNoRelocation if unused
+	int16 opparams[4];
+	uint16 size;        ///< size of the instruction in bytes
+	byte extOpcode;
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -94,6 +102,17 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	enum {
+		/** Number of entries in _instructionCache, must be a power of two */
+		kInstructionCacheSize = 512
+	};
+
+	/**
+	 * Direct mapped cache of decoded instructions, indexed by their offset.
+	 * Only allocated once the VM executes code of this script.
+	 */
+	mutable Common::Array<DecodedInstruction> _instructionCache;
+
 protected:
 	offsetLookupArrayType _offsetLookupArray; // Table of all elements of currently loaded script, that may get pointed to
 
@@ -120,6 +139,14 @@ public:
 	const byte *getBuf(uint offset = 0) const { return _buf->getUnsafeDataAt(offset); }
 	SciSpan<const byte> getSpan(uint offset) const { return _buf->subspan(offset); }
 
+	/**
+	 * Decode the VM instruction at the given offset, like
+	 * readPMachineInstruction() does. Recently executed instructions are
+	 * cached, so that loops do not decode the same code over and over.
+	 * @return the size of the instruction in bytes
+	 */
+	int decodeInstruction(uint32 offset, byte &extOpcode, int16 opparams[4]) const;
+
 	int getScriptNumber() const { return _nr; }
 	SegmentId getLocalsSegment() const { return _localsSegment; }
 	reg_t *getLocalsBegin() { return _localsBlock ? _localsBlock->_locals.begin() : NULL; }
@@ -103,6 +103,7 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	gcStatistics.reset();
 
 #ifdef ENABLE_SCI32
 	_eventCounter = 0;
@@ -98,6 +98,26 @@ struct SciCallOrigin {
 	}
 };
 
+/**
+ * Statistics about the pauses caused by the garbage collector, shown by the
+ * gc_stats console command. All times are in milliseconds.
+ */
+struct GCStatistics {
+	uint32 collections;   ///< Number of collections so far
+	uint32 totalTime;     ///< Sum of the pauses of all collections
+	uint32 maxTime;       ///< Longest pause so far
+	uint32 lastMarkTime;  ///< Time the last collection spent finding all active references
+	uint32 lastSweepTime; ///< Time the last collection spent freeing the unreachable objects
+	uint32 lastReachable; ///< Number of reachable addresses found by the last collection
+	uint32 lastFreed;     ///< Number of objects freed by the last collection
+
+	GCStatistics() { reset(); }
+	void reset() {
+		collections = totalTime = maxTime = 0;
+		lastMarkTime = lastSweepTime = lastReachable = lastFreed = 0;
+	}
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -194,6 +214,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStatistics gcStatistics; /**< Pause times of the garbage collector */
 
 	MessageState *_msgState;
 
@@ -665,7 +665,7 @@ void run_vm(EngineState *s) {
 		// Get opcode
 		byte extOpcode;
 		if (!vmHooks.isActive(s))
-			s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+			s->xs->addr.pc.incOffset(scr->decodeInstruction(s->xs->addr.pc.getOffset(), extOpcode, opparams));
 		else {
 			int offset = readPMachineInstruction(vmHooks.data(), extOpcode, opparams);
 			vmHooks.advance(offset);
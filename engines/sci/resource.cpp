@@ -388,9 +388,10 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 		}
 		++it;
 	}
-	// adding a new file
+	// adding a new file. Volumes are read-only and accessed at random, so
+	// they are mapped into memory where possible.
 	file = new Common::File;
-	if (file->open(filename)) {
+	if (file->openMapped(filename)) {
 		if (_volumeFiles.size() == MAX_OPENED_VOLUMES) {
 			it = --_volumeFiles.end();
 			delete *it;
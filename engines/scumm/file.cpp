@@ -59,6 +59,15 @@ bool ScummFile::open(const Common::String &filename) {
 	}
 }
 
+bool ScummFile::openResource(const Common::String &filename) {
+	if (File::openMapped(filename)) {
+		resetSubfile();
+		return true;
+	} else {
+		return false;
+	}
+}
+
 bool ScummFile::openSubFile(const Common::String &filename) {
 	assert(isOpen());
 
@@ -41,6 +41,12 @@ public:
 	bool open(const Common::String &filename) override = 0;
 	virtual bool openSubFile(const Common::String &filename) = 0;
 
+	/**
+	 * Open a room or data file, which is mapped into memory if the
+	 * subclass supports that.
+	 */
+	virtual bool openResource(const Common::String &filename) { return open(filename); }
+
 	int32 pos() const override = 0;
 	int32 size() const override = 0;
 	bool seek(int32 offs, int whence = SEEK_SET) override = 0;
@@ -66,6 +72,7 @@ public:
 
 	bool open(const Common::String &filename) override;
 	bool openSubFile(const Common::String &filename) override;
+	bool openResource(const Common::String &filename) override;
 
 	void clearErr() override { _myEos = false; BaseScummFile::clearErr(); }
 
@@ -139,6 +146,7 @@ public:
 	ScummSteamFile(const SteamIndexFile &indexFile) : ScummFile(), _indexFile(indexFile) {}
 
 	bool open(const Common::String &filename) override;
+	bool openResource(const Common::String &filename) override { return open(filename); }
 };
 
 } // End of namespace Scumm
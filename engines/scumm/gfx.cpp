@@ -44,6 +44,14 @@
 extern "C" void asmDrawStripToScreen(int height, int width, void const* text, void const* src, byte* dst,
 	int vsPitch, int vmScreenWidth, int textSurfacePitch);
 extern "C" void asmCopy8Col(byte* dst, int dstPitch, const byte* src, int height, uint8 bitDepth);
+
+#elif defined(__SSE2__) || defined(_M_X64)
+#define SCUMM_GFX_USE_SSE2
+#include <emmintrin.h>
+
+#elif defined(__ARM_NEON)
+#define SCUMM_GFX_USE_NEON
+#include <arm_neon.h>
 #endif /* USE_ARM_GFX_ASM */
 
 namespace Scumm {
@@ -577,26 +585,47 @@ void ScummEngine::updateDirtyScreen(VirtScreenNumber slot) {
 	if (vs->h == 0)
 		return;
 
-	int i;
-	int w = 8;
-	int start = 0;
-
-	for (i = 0; i < _gdi->_numStrips; i++) {
-		if (vs->bdirty[i]) {
-			const int top = vs->tdirty[i];
-			const int bottom = vs->bdirty[i];
-			vs->tdirty[i] = vs->h;
-			vs->bdirty[i] = 0;
-			if (i != (_gdi->_numStrips - 1) && vs->bdirty[i + 1] == bottom && vs->tdirty[i + 1] == top) {
-				// Simple optimizations: if two or more neighboring strips
-				// form one bigger rectangle, coalesce them.
-				w += 8;
-				continue;
-			}
-			drawStripToScreen(vs, start * 8, w, top, bottom);
-			w = 8;
+	int i = 0;
+
+	while (i < _gdi->_numStrips) {
+		if (!vs->bdirty[i]) {
+			i++;
+			continue;
+		}
+
+		// Coalesce neighboring dirty strips into one rectangle, as long as
+		// at least half of it is actually dirty. Redrawing a few clean
+		// pixels is cheaper than a separate blit for every strip.
+		const int start = i;
+		int top = vs->tdirty[i];
+		int bottom = vs->bdirty[i];
+		int dirtyArea = bottom - top;
+
+		for (i++; i < _gdi->_numStrips && vs->bdirty[i]; i++) {
+			// MM NES blanks the screen instead of drawing a full screen
+			// rectangle (see drawStripToScreen), so only coalesce strips
+			// which are exactly alike there, lest a partial update turns
+			// into one
+			if (_game.platform == Common::kPlatformNES && (vs->tdirty[i] != top || vs->bdirty[i] != bottom))
+				break;
+
+			const int newTop = MIN<int>(top, vs->tdirty[i]);
+			const int newBottom = MAX<int>(bottom, vs->bdirty[i]);
+			const int newDirtyArea = dirtyArea + vs->bdirty[i] - vs->tdirty[i];
+			if ((newBottom - newTop) * (i - start + 1) > 2 * newDirtyArea)
+				break;
+
+			top = newTop;
+			bottom = newBottom;
+			dirtyArea = newDirtyArea;
+		}
+
+		for (int j = start; j < i; j++) {
+			vs->tdirty[j] = vs->h;
+			vs->bdirty[j] = 0;
 		}
-		start = i + 1;
+
+		drawStripToScreen(vs, start * 8, (i - start) * 8, top, bottom);
 	}
 }
 
@@ -675,6 +704,17 @@ void ScummEngine::drawStripToScreen(VirtScreen *vs, int x, int width, int top, i
 
 			for (int h = 0; h < height * m; ++h) {
 				for (int w = 0; w < width * m; ++w) {
+					// Runs of four transparent text pixels, which is what
+					// most of the screen consists of, are copied as a whole
+					if (vs->format.bytesPerPixel == 2 && !(w & 3) && READ_UINT32(textPtr) == CHARSET_MASK_TRANSPARENCY_32) {
+						memcpy(dstPtr, srcPtr, 8);
+						dstPtr += 8;
+						srcPtr += 8;
+						textPtr += 4;
+						w += 3;
+						continue;
+					}
+
 					uint16 tmp = *textPtr++;
 					if (tmp == CHARSET_MASK_TRANSPARENCY) {
 						tmp = READ_UINT16(srcPtr);
@@ -702,7 +742,33 @@ void ScummEngine::drawStripToScreen(VirtScreen *vs, int x, int width, int top, i
 			const uint32 *text32 = (const uint32 *)text;
 			const int textPitch = (_textSurface.pitch - width * m) >> 2;
 			for (int h = height * m; h > 0; --h) {
-				for (int w = width * m; w > 0; w -= 4) {
+				int w = width * m;
+
+#if defined(SCUMM_GFX_USE_SSE2)
+				// Sixteen pixels at a time, where SIMD instructions are available
+				const __m128i transparent = _mm_set1_epi8((char)CHARSET_MASK_TRANSPARENCY);
+				for (; w >= 16; w -= 16) {
+					const __m128i textPixels = _mm_loadu_si128((const __m128i *)text32);
+					const __m128i srcPixels = _mm_loadu_si128((const __m128i *)src32);
+					const __m128i mask = _mm_cmpeq_epi8(textPixels, transparent);
+					_mm_storeu_si128((__m128i *)dst32, _mm_or_si128(_mm_and_si128(mask, srcPixels), _mm_andnot_si128(mask, textPixels)));
+					text32 += 4;
+					src32 += 4;
+					dst32 += 4;
+				}
+#elif defined(SCUMM_GFX_USE_NEON)
+				const uint8x16_t transparent = vdupq_n_u8(CHARSET_MASK_TRANSPARENCY);
+				for (; w >= 16; w -= 16) {
+					const uint8x16_t textPixels = vld1q_u8((const uint8 *)text32);
+					const uint8x16_t srcPixels = vld1q_u8((const uint8 *)src32);
+					vst1q_u8((uint8 *)dst32, vbslq_u8(vceqq_u8(textPixels, transparent), srcPixels, textPixels));
+					text32 += 4;
+					src32 += 4;
+					dst32 += 4;
+				}
+#endif
+
+				for (; w > 0; w -= 4) {
 					uint32 temp = *text32++;
 
 					// Generate a byte mask for those text pixels (bytes) with
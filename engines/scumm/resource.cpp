@@ -194,7 +194,7 @@ bool ScummEngine::openFile(BaseScummFile &file, const Common::String &filename,
 
 	if (!result) {
 		file.close();
-		result = file.open(filename);
+		result = resourceFile ? file.openResource(filename) : file.open(filename);
 	}
 
 	return result;
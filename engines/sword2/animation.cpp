@@ -381,6 +381,7 @@ bool MoviePlayer::playVideo() {
 			if ((event.type == Common::EVENT_KEYDOWN && event.kbd.keycode == Common::KEYCODE_ESCAPE) || event.type == Common::EVENT_LBUTTONUP)
 				return false;
 
+		_decoder->decodeAhead();
 		_vm->_system->delayMillis(10);
 	}
 
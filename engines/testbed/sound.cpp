@@ -20,6 +20,7 @@
  *
  */
 
+#include "audio/audiostream.h"
 #include "audio/softsynth/pcspk.h"
 
 #include "backends/audiocd/audiocd.h"
@@ -39,6 +40,46 @@ enum {
 	kPauseChannel3 = 'pac3'
 };
 
+/**
+ * Silent stream which records the intervals between the mixer callbacks
+ * pulling data from it.
+ */
+class CallbackProbeStream : public Audio::AudioStream {
+public:
+	CallbackProbeStream(int rate) : _rate(rate), _lastCall(0), _calls(0), _maxGap(0), _maxSamples(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const uint32 now = g_system->getMillis();
+		if (_calls > 0)
+			_maxGap = MAX(_maxGap, now - _lastCall);
+		_lastCall = now;
+		_calls++;
+		_maxSamples = MAX(_maxSamples, numSamples);
+
+		memset(buffer, 0, numSamples * sizeof(int16));
+		return numSamples;
+	}
+
+	bool isStereo() const override { return true; }
+	int getRate() const override { return _rate; }
+	bool endOfData() const override { return false; }
+
+	/** Reset the statistics, e.g. after the warm-up phase */
+	void reset() { _calls = 0; _maxGap = 0; }
+
+	uint32 getCalls() const { return _calls; }
+	uint32 getMaxGap() const { return _maxGap; }
+	/** The nominal time between two callbacks, in milliseconds */
+	uint32 getPeriod() const { return _maxSamples * 1000 / (2 * _rate); }
+
+private:
+	const int _rate;
+	uint32 _lastCall;
+	uint32 _calls;
+	uint32 _maxGap;
+	int _maxSamples;
+};
+
 SoundSubsystemDialog::SoundSubsystemDialog() : TestbedInteractionDialog(80, 60, 400, 170) {
 	_xOffset = 25;
 	_yOffset = 0;
@@ -261,6 +302,80 @@ TestExitStatus SoundSubsystem::sampleRates() {
 	return passed;
 }
 
+TestExitStatus SoundSubsystem::mixerStress() {
+	Common::String info = "Testing Mixer responsiveness under load.\n"
+						  "Channel operations are issued continuously for a few seconds while\n"
+						  "the time between audio callbacks is measured. You should hear nothing.";
+
+	if (Testsuite::handleInteractiveInput(info, "OK", "Skip", kOptionRight)) {
+		Testsuite::logPrintf("Info! Skipping test : Mixer Stress\n");
+		return kTestSkipped;
+	}
+
+	Audio::Mixer *mixer = g_system->getMixer();
+
+	const int kNumChannels = 16;
+	Audio::SoundHandle handles[kNumChannels];
+	for (int i = 0; i < kNumChannels; i++) {
+		Audio::PCSpeaker *speaker = new Audio::PCSpeaker();
+		speaker->play(Audio::PCSpeaker::kWaveFormSine, 1000 + i * 50, -1);
+		mixer->playStream(Audio::Mixer::kPlainSoundType, &handles[i], speaker, -1, 0);
+	}
+
+	CallbackProbeStream *probe = new CallbackProbeStream(mixer->getOutputRate());
+	Audio::SoundHandle probeHandle;
+	mixer->playStream(Audio::Mixer::kPlainSoundType, &probeHandle, probe, -1, 0, 0, DisposeAfterUse::NO);
+
+	Common::Point pt(0, 100);
+	Testsuite::writeOnScreen("Stressing the mixer...", pt);
+
+	// Let the backend settle first
+	g_system->delayMillis(200);
+	probe->reset();
+
+	uint32 operations = 0;
+	const uint32 start = g_system->getMillis();
+	while (g_system->getMillis() - start < 3000) {
+		for (int i = 0; i < kNumChannels; i++) {
+			mixer->setChannelVolume(handles[i], 0);
+			mixer->setChannelBalance(handles[i], (int8)((operations + i) % 255 - 127));
+			mixer->pauseHandle(handles[i], true);
+			mixer->pauseHandle(handles[i], false);
+			mixer->isSoundHandleActive(handles[i]);
+			mixer->getElapsedTime(handles[i]);
+			operations += 6;
+		}
+
+		// Restart one channel per round
+		const int restart = operations % kNumChannels;
+		mixer->stopHandle(handles[restart]);
+		Audio::PCSpeaker *speaker = new Audio::PCSpeaker();
+		speaker->play(Audio::PCSpeaker::kWaveFormSine, 1000, -1);
+		mixer->playStream(Audio::Mixer::kPlainSoundType, &handles[restart], speaker, -1, 0);
+		operations += 2;
+	}
+	const uint32 elapsed = g_system->getMillis() - start;
+
+	mixer->stopHandle(probeHandle);
+	for (int i = 0; i < kNumChannels; i++)
+		mixer->stopHandle(handles[i]);
+
+	Testsuite::clearScreen();
+	Testsuite::logDetailedPrintf("Mixer stress: %u channel operations in %u ms, %u callbacks, callback period %u ms, largest gap %u ms\n",
+	                             operations, elapsed, probe->getCalls(), probe->getPeriod(), probe->getMaxGap());
+
+	TestExitStatus passed = kTestPassed;
+	// Allow for some scheduling jitter, but a blocked callback shows up as
+	// gaps of several periods.
+	if (probe->getCalls() == 0 || probe->getMaxGap() > 3 * probe->getPeriod() + 10) {
+		Testsuite::logDetailedPrintf("Error! The mixer callback was delayed by channel operations\n");
+		passed = kTestFailed;
+	}
+
+	delete probe;
+	return passed;
+}
+
 SoundSubsystemTestSuite::SoundSubsystemTestSuite() {
 	addTest("SimpleBeeps", &SoundSubsystem::playBeeps, true);
 	addTest("MixSounds", &SoundSubsystem::mixSounds, true);
@@ -276,6 +391,7 @@ SoundSubsystemTestSuite::SoundSubsystemTestSuite() {
 		}
 	}
 	addTest("SampleRates", &SoundSubsystem::sampleRates, true);
+	addTest("MixerStress", &SoundSubsystem::mixerStress, true);
 }
 
 } // End of namespace Testbed
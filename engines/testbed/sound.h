@@ -47,6 +47,7 @@ TestExitStatus playBeeps();
 TestExitStatus mixSounds();
 TestExitStatus audiocdOutput();
 TestExitStatus sampleRates();
+TestExitStatus mixerStress();
 }
 
 class SoundSubsystemTestSuite : public Testsuite {
@@ -478,6 +478,15 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const Common::Rect &clip, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets the colors and drawing settings of the specified draw step,
+	 * like drawStep() does, without drawing anything. Settings not given
+	 * by the step are kept for the following steps.
+	 *
+	 * @see drawStep
+	 */
+	void applyStepState(const Common::Rect &area, const Common::Rect &clip, const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -34,6 +34,14 @@
 
 #define VECTOR_RENDERER_FAST_TRIANGLES
 
+#if defined(SCUMM_LITTLE_ENDIAN) && (defined(__SSE2__) || defined(_M_X64))
+#define VECTOR_RENDERER_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define VECTOR_RENDERER_USE_NEON
+#include <arm_neon.h>
+#endif
+
 /** Fixed point SQUARE ROOT **/
 inline frac_t fp_sqroot(uint32 x) {
 #if 0
@@ -424,41 +432,87 @@ inline frac_t fp_sqroot(uint32 x) {
 
 namespace Graphics {
 
+#if defined(VECTOR_RENDERER_USE_SSE2)
+/** Returns a vector filled with the two given colors, alternating. */
+template<typename PixelType>
+inline __m128i alternateSSE2(PixelType color1, PixelType color2) {
+	if (sizeof(PixelType) == 4)
+		return _mm_set_epi32(color2, color1, color2, color1);
+	else
+		return _mm_set_epi16(color2, color1, color2, color1, color2, color1, color2, color1);
+}
+#elif defined(VECTOR_RENDERER_USE_NEON)
+template<typename PixelType>
+inline uint8x16_t alternateNEON(PixelType color1, PixelType color2) {
+	if (sizeof(PixelType) == 4) {
+		const uint32x2_t pair = vset_lane_u32(color2, vdup_n_u32(color1), 1);
+		return vreinterpretq_u8_u32(vcombine_u32(pair, pair));
+	} else {
+		const uint16x4_t pair = vset_lane_u16(color2, vset_lane_u16(color2, vdup_n_u16(color1), 1), 3);
+		return vreinterpretq_u8_u16(vcombine_u16(pair, pair));
+	}
+}
+#endif
+
+/**
+ * Fills several pixels in a row with two colors, alternating, starting
+ * with the first one.
+ *
+ * Whole vectors get stored at once where SIMD is available. They contain an
+ * even number of pixels, so the pattern continues across them.
+ *
+ * @param first Pointer to the first pixel to fill.
+ * @param last Pointer to the last pixel to fill.
+ * @param color1 Color of the first pixel, and of every other one after it
+ * @param color2 Color of the second pixel, and of every other one after it
+ */
+template<typename PixelType>
+void colorFillAlternate(PixelType *first, PixelType *last, PixelType color1, PixelType color2) {
+	const int perVector = 16 / sizeof(PixelType);
+	int count = (last - first);
+
+#if defined(VECTOR_RENDERER_USE_SSE2)
+	if (count >= perVector) {
+		const __m128i pattern = alternateSSE2<PixelType>(color1, color2);
+		for (; count >= 2 * perVector; count -= 2 * perVector, first += 2 * perVector) {
+			_mm_storeu_si128((__m128i *)first, pattern);
+			_mm_storeu_si128((__m128i *)(first + perVector), pattern);
+		}
+		for (; count >= perVector; count -= perVector, first += perVector)
+			_mm_storeu_si128((__m128i *)first, pattern);
+	}
+#elif defined(VECTOR_RENDERER_USE_NEON)
+	if (count >= perVector) {
+		const uint8x16_t pattern = alternateNEON<PixelType>(color1, color2);
+		for (; count >= perVector; count -= perVector, first += perVector)
+			vst1q_u8((uint8 *)first, pattern);
+	}
+#endif
+
+	for (; count >= 2; count -= 2) {
+		*first++ = color1;
+		*first++ = color2;
+	}
+	if (count)
+		*first = color1;
+}
+
 /**
  * Fills several pixels in a row with a given color.
  *
- * This is a replacement function for Common::fill, using an unrolled
- * loop to maximize performance on most architectures.
- * This function may (and should) be overloaded in any child renderers
- * for portable platforms with platform-specific assembly code.
+ * This is a replacement function for Common::fill. Where SIMD is available,
+ * whole vectors of pixels get stored at once.
  *
  * This fill operation is extensively used throughout the renderer, so this
- * counts as one of the main bottlenecks. Please replace it with assembly
- * when possible!
+ * counts as one of the main bottlenecks.
  *
  * @param first Pointer to the first pixel to fill.
  * @param last Pointer to the last pixel to fill.
  * @param color Color of the pixel
  */
 template<typename PixelType>
-void colorFill(PixelType *first, PixelType *last, PixelType color) {
-	int count = (last - first);
-	if (!count)
-		return;
-	int n = (count + 7) >> 3;
-	switch (count % 8) {
-	default:
-	case 0:	do {
-	       		*first++ = color; // fall through
-	case 7:		*first++ = color; // fall through
-	case 6:		*first++ = color; // fall through
-	case 5:		*first++ = color; // fall through
-	case 4:		*first++ = color; // fall through
-	case 3:		*first++ = color; // fall through
-	case 2:		*first++ = color; // fall through
-	case 1:		*first++ = color;
-	       	} while (--n > 0);
-	}
+inline void colorFill(PixelType *first, PixelType *last, PixelType color) {
+	colorFillAlternate<PixelType>(first, last, color, color);
 }
 
 template<typename PixelType>
@@ -483,23 +537,10 @@ void colorFillClip(PixelType *first, PixelType *last, PixelType color, int realX
 		count -= diff;
 	}
 
-	if (!count)
+	if (count <= 0)
 		return;
 
-	int n = (count + 7) >> 3;
-	switch (count % 8) {
-	default:
-	case 0:	do {
-	       		*first++ = color; // fall through
-	case 7:		*first++ = color; // fall through
-	case 6:		*first++ = color; // fall through
-	case 5:		*first++ = color; // fall through
-	case 4:		*first++ = color; // fall through
-	case 3:		*first++ = color; // fall through
-	case 2:		*first++ = color; // fall through
-	case 1:		*first++ = color;
-	       	} while (--n > 0);
-	}
+	colorFill<PixelType>(first, first + count, color);
 }
 
 
@@ -538,7 +579,10 @@ VectorRendererSpec(PixelFormat format) :
 	_redMask((0xFF >> format.rLoss) << format.rShift),
 	_greenMask((0xFF >> format.gLoss) << format.gShift),
 	_blueMask((0xFF >> format.bLoss) << format.bShift),
-	_alphaMask((0xFF >> format.aLoss) << format.aShift) {
+	_alphaMask((0xFF >> format.aLoss) << format.aShift),
+	_byteChannels(format.bytesPerPixel == 4 && !format.rLoss && !format.gLoss && !format.bLoss &&
+	              (!format.aLoss || format.aLoss == 8) &&
+	              !(format.rShift % 8) && !(format.gShift % 8) && !(format.bShift % 8) && !(format.aShift % 8)) {
 
 	_bitmapAlphaColor = _format.RGBToColor(255, 0, 255);
 	_clippingArea = Common::Rect(0, 0, 32767, 32767);
@@ -634,16 +678,13 @@ gradientFill(PixelType *ptr, int width, int x, int y) {
 	} else if (grad == 3 && ox) {
 		colorFill<PixelType>(ptr, ptr + width, _gradCache[curGrad + 1]);
 	} else {
-		for (int j = x; j < x + width; j++, ptr++) {
-			bool oy = ((j & 1) == 1);
-
-			if ((ox && oy) ||
-				((grad == 2 || grad == 3) && ox && !oy) ||
-				(grad == 3 && oy))
-				*ptr = _gradCache[curGrad + 1];
-			else
-				*ptr = _gradCache[curGrad];
-		}
+		// The pattern only depends on whether the column is odd
+		const PixelType evenColor = (grad >= 2 && ox) ? _gradCache[curGrad + 1] : _gradCache[curGrad];
+		const PixelType oddColor = (ox || grad == 3) ? _gradCache[curGrad + 1] : _gradCache[curGrad];
+		if (x & 1)
+			colorFillAlternate<PixelType>(ptr, ptr + width, oddColor, evenColor);
+		else
+			colorFillAlternate<PixelType>(ptr, ptr + width, evenColor, oddColor);
 	}
 }
 
@@ -676,17 +717,19 @@ gradientFillClip(PixelType *ptr, int width, int x, int y, int realX, int realY)
 	} else if (grad == 3 && ox) {
 		colorFillClip<PixelType>(ptr, ptr + width, _gradCache[curGrad + 1], realX, realY, _clippingArea);
 	} else {
-		for (int j = x; j < x + width; j++, ptr++) {
-			if (realX + j - x < _clippingArea.left || realX + j - x >= _clippingArea.right) continue;
-			bool oy = ((j & 1) == 1);
-
-			if ((ox && oy) ||
-				((grad == 2 || grad == 3) && ox && !oy) ||
-				(grad == 3 && oy))
-				*ptr = _gradCache[curGrad + 1];
-			else
-				*ptr = _gradCache[curGrad];
-		}
+		PixelType *last = ptr + width;
+		PixelType *first = ptr;
+		if (!clipSpan(first, last, realX, realY))
+			return;
+		x += first - ptr;
+
+		// The pattern only depends on whether the column is odd
+		const PixelType evenColor = (grad >= 2 && ox) ? _gradCache[curGrad + 1] : _gradCache[curGrad];
+		const PixelType oddColor = (ox || grad == 3) ? _gradCache[curGrad + 1] : _gradCache[curGrad];
+		if (x & 1)
+			colorFillAlternate<PixelType>(first, last, oddColor, evenColor);
+		else
+			colorFillAlternate<PixelType>(first, last, evenColor, oddColor);
 	}
 }
 
@@ -960,63 +1003,117 @@ blendPixelDestAlphaPtr(PixelType *ptr, PixelType color, uint8 alpha) {
 }
 
 template<typename PixelType>
-inline void VectorRendererSpec<PixelType>::
-darkenFill(PixelType *ptr, PixelType *end) {
-	PixelType mask = (PixelType)((3 << _format.rShift) | (3 << _format.gShift) | (3 << _format.bShift));
+bool VectorRendererSpec<PixelType>::
+clipSpan(PixelType *&first, PixelType *&last, int realX, int realY) const {
+	if (realY < _clippingArea.top || realY >= _clippingArea.bottom)
+		return false;
+
+	const int count = last - first;
+	if (realX < _clippingArea.left)
+		first += _clippingArea.left - realX;
+	if (realX + count > _clippingArea.right)
+		last -= realX + count - _clippingArea.right;
+	return first < last;
+}
 
-	if (!g_system->hasFeature(OSystem::kFeatureOverlaySupportsAlpha)) {
-		// !kFeatureOverlaySupportsAlpha (but might have alpha bits)
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
+	if (alpha == 0xff) {
+		colorFill<PixelType>(first, last, color | _alphaMask);
+		return;
+	}
 
-		while (ptr != end) {
-			*ptr = ((*ptr & ~mask) >> 2) | _alphaMask;
-			++ptr;
-		}
-	} else {
-		// kFeatureOverlaySupportsAlpha
-		// assuming at least 3 alpha bits
+#if defined(VECTOR_RENDERER_USE_SSE2)
+	// Every channel gets blended as d + (((s - d) * alpha) >> 8), which is
+	// the same as (d * (256 - alpha) + s * alpha) >> 8, without any negative
+	// intermediate value. The alpha channel gets blended towards opaque.
+	if (_byteChannels && last - first >= 4) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i srcTerm = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(color | _alphaMask), zero), _mm_set1_epi16(alpha));
+		const __m128i dstWeight = _mm_set1_epi16(256 - alpha);
+		const __m128i channels = _mm_set1_epi32(_redMask | _greenMask | _blueMask | _alphaMask);
 
-		mask |= 3 << _format.aShift;
-		PixelType addA = (PixelType)(3 << (_format.aShift + 6 - _format.aLoss));
+		for (; last - first >= 4; first += 4) {
+			const __m128i dst = _mm_loadu_si128((const __m128i *)first);
+			const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), dstWeight), srcTerm), 8);
+			const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), dstWeight), srcTerm), 8);
+			_mm_storeu_si128((__m128i *)first, _mm_and_si128(_mm_packus_epi16(lo, hi), channels));
+		}
+	}
+#elif defined(VECTOR_RENDERER_USE_NEON)
+	if (_byteChannels && last - first >= 4) {
+		const uint8x8_t srcAlpha = vdup_n_u8(alpha);
+		const uint8x8_t dstAlpha = vdup_n_u8(255 - alpha);
+		const uint8x8_t src = vreinterpret_u8_u32(vdup_n_u32(color | _alphaMask));
+		const uint16x8_t srcTerm = vmull_u8(src, srcAlpha);
+		const uint8x16_t channels = vreinterpretq_u8_u32(vdupq_n_u32(_redMask | _greenMask | _blueMask | _alphaMask));
 
-		while (ptr != end) {
-			// Darken the color, and increase the alpha
-			// (0% -> 75%, 100% -> 100%)
-			*ptr = (PixelType)(((*ptr & ~mask) >> 2) + addA);
-			++ptr;
+		for (; last - first >= 4; first += 4) {
+			const uint8x16_t dst = vld1q_u8((const uint8 *)first);
+			// d * (256 - alpha) is d * (255 - alpha) + d
+			const uint16x8_t lo = vaddw_u8(vmlal_u8(srcTerm, vget_low_u8(dst), dstAlpha), vget_low_u8(dst));
+			const uint16x8_t hi = vaddw_u8(vmlal_u8(srcTerm, vget_high_u8(dst), dstAlpha), vget_high_u8(dst));
+			vst1q_u8((uint8 *)first, vandq_u8(vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)), channels));
 		}
 	}
+#endif
+
+	while (first != last)
+		blendPixelPtr(first++, color, alpha);
 }
 
 template<typename PixelType>
-inline void VectorRendererSpec<PixelType>::
-darkenFillClip(PixelType *ptr, PixelType *end, int x, int y) {
-	PixelType mask = (PixelType)((3 << _format.rShift) | (3 << _format.gShift) | (3 << _format.bShift));
+void VectorRendererSpec<PixelType>::
+blendFillClip(PixelType *first, PixelType *last, PixelType color, uint8 alpha, int realX, int realY) {
+	if (clipSpan(first, last, realX, realY))
+		blendFill(first, last, color, alpha);
+}
 
-	if (!g_system->hasFeature(OSystem::kFeatureOverlaySupportsAlpha)) {
-		// !kFeatureOverlaySupportsAlpha (but might have alpha bits)
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+darkenFill(PixelType *ptr, PixelType *end) {
+	PixelType mask = (PixelType)((3 << _format.rShift) | (3 << _format.gShift) | (3 << _format.bShift));
+	PixelType add = 0, set = _alphaMask;
 
-		while (ptr != end) {
-			if (IS_IN_CLIP(x, y)) *ptr = ((*ptr & ~mask) >> 2) | _alphaMask;
-			++ptr;
-			++x;
-		}
-	} else {
-		// kFeatureOverlaySupportsAlpha
+	if (g_system->hasFeature(OSystem::kFeatureOverlaySupportsAlpha)) {
+		// Darken the color, and increase the alpha
+		// (0% -> 75%, 100% -> 100%)
 		// assuming at least 3 alpha bits
-
 		mask |= 3 << _format.aShift;
-		PixelType addA = (PixelType)(3 << (_format.aShift + 6 - _format.aLoss));
+		add = (PixelType)(3 << (_format.aShift + 6 - _format.aLoss));
+		set = 0;
+	}
+
+#if defined(VECTOR_RENDERER_USE_SSE2)
+	// Both pixel sizes fit a whole number of times in 32 bits
+	const uint32 repeat = (sizeof(PixelType) == 4) ? 1 : 0x10001;
+	const __m128i keepMask = _mm_set1_epi32((uint32)(PixelType)~mask * repeat);
+	const __m128i addVector = _mm_set1_epi32((uint32)add * repeat);
+	const __m128i setVector = _mm_set1_epi32((uint32)set * repeat);
+	for (; end - ptr >= (int)(16 / sizeof(PixelType)); ptr += 16 / sizeof(PixelType)) {
+		__m128i pixels = _mm_and_si128(_mm_loadu_si128((const __m128i *)ptr), keepMask);
+		if (sizeof(PixelType) == 4)
+			pixels = _mm_add_epi32(_mm_srli_epi32(pixels, 2), addVector);
+		else
+			pixels = _mm_add_epi16(_mm_srli_epi16(pixels, 2), addVector);
+		_mm_storeu_si128((__m128i *)ptr, _mm_or_si128(pixels, setVector));
+	}
+#endif
 
-		while (ptr != end) {
-			// Darken the color, and increase the alpha
-			// (0% -> 75%, 100% -> 100%)
-			if (IS_IN_CLIP(x, y)) *ptr = (PixelType)(((*ptr & ~mask) >> 2) + addA);
-			++ptr;
-			++x;
-		}
+	while (ptr != end) {
+		*ptr = (PixelType)((((*ptr & ~mask) >> 2) + add) | set);
+		++ptr;
 	}
 }
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+darkenFillClip(PixelType *ptr, PixelType *end, int x, int y) {
+	if (clipSpan(ptr, end, x, y))
+		darkenFill(ptr, end);
+}
+
 /********************************************************************
  ********************************************************************
  * Primitive shapes drawing - Public API calls - VectorRendererSpec *
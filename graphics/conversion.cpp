@@ -25,6 +25,11 @@
 
 #include "common/endian.h"
 
+#if defined(SCUMM_LITTLE_ENDIAN) && (defined(__SSE2__) || defined(_M_X64))
+#define GRAPHICS_CONVERSION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Graphics {
 
 // TODO: YUV to RGB conversion function
@@ -115,6 +120,197 @@ inline void crossBlitLogic3BppSource(byte *dst, const byte *src, const uint w, c
 	}
 }
 
+/**
+ * A pixel format known at compile time. Conversions between two of these
+ * get all the shifts and masks folded into constants, and can be
+ * vectorized.
+ */
+template<typename Pixel, int RBits, int GBits, int BBits, int ABits, int RShift, int GShift, int BShift, int AShift>
+struct FixedFormat {
+	typedef Pixel PixelType;
+
+	enum {
+		kRBits = RBits, kGBits = GBits, kBBits = BBits, kABits = ABits,
+		kRShift = RShift, kGShift = GShift, kBShift = BShift, kAShift = AShift
+	};
+
+	static bool matches(const PixelFormat &format) {
+		return format == PixelFormat(sizeof(Pixel), RBits, GBits, BBits, ABits, RShift, GShift, BShift, AShift);
+	}
+
+	static inline void colorToARGB(uint32 color, byte &a, byte &r, byte &g, byte &b) {
+		a = (ABits == 0) ? 0xFF : ColorComponent<ABits>::expand(color >> AShift);
+		r = ColorComponent<RBits>::expand(color >> RShift);
+		g = ColorComponent<GBits>::expand(color >> GShift);
+		b = ColorComponent<BBits>::expand(color >> BShift);
+	}
+
+	static inline Pixel ARGBToColor(byte a, byte r, byte g, byte b) {
+		return ((a >> (8 - ABits)) << AShift) |
+		       ((r >> (8 - RBits)) << RShift) |
+		       ((g >> (8 - GBits)) << GShift) |
+		       ((b >> (8 - BBits)) << BShift);
+	}
+};
+
+typedef FixedFormat<uint16, 5, 6, 5, 0, 11, 5, 0, 0> FormatRGB565;
+typedef FixedFormat<uint16, 5, 5, 5, 0, 10, 5, 0, 0> FormatRGB555;
+typedef FixedFormat<uint32, 8, 8, 8, 8, 16, 8, 0, 24> FormatARGB8888;
+typedef FixedFormat<uint32, 8, 8, 8, 8, 24, 16, 8, 0> FormatRGBA8888;
+typedef FixedFormat<uint32, 8, 8, 8, 8, 0, 8, 16, 24> FormatABGR8888;
+typedef FixedFormat<uint32, 8, 8, 8, 8, 8, 16, 24, 0> FormatBGRA8888;
+
+template<typename SrcFormat, typename DstFormat>
+inline typename DstFormat::PixelType convertFixed(typename SrcFormat::PixelType color) {
+	byte a, r, g, b;
+	SrcFormat::colorToARGB(color, a, r, g, b);
+	return DstFormat::ARGBToColor(a, r, g, b);
+}
+
+#ifdef GRAPHICS_CONVERSION_USE_SSE2
+
+/**
+ * Extract a component from 32 bit lanes and expand it to 8 bits. All
+ * formats above have components of at least 4 bits, for which the
+ * expansion is a single shift and or.
+ */
+template<int bits, int shift>
+inline __m128i extractComponentSSE2(__m128i color) {
+	const __m128i value = _mm_and_si128(_mm_srli_epi32(color, shift), _mm_set1_epi32((1 << bits) - 1));
+	return _mm_or_si128(_mm_slli_epi32(value, 8 - bits), _mm_srli_epi32(value, 2 * bits - 8));
+}
+
+template<int bits, int shift>
+inline __m128i insertComponentSSE2(__m128i value) {
+	return _mm_slli_epi32(_mm_srli_epi32(value, 8 - bits), shift);
+}
+
+/** Vectorized convertFixed(), for four pixels in 32 bit lanes. */
+template<typename SrcFormat, typename DstFormat>
+inline __m128i convertFixedSSE2(__m128i color) {
+	__m128i result = _mm_or_si128(
+		_mm_or_si128(insertComponentSSE2<DstFormat::kRBits, DstFormat::kRShift>(extractComponentSSE2<SrcFormat::kRBits, SrcFormat::kRShift>(color)),
+		             insertComponentSSE2<DstFormat::kGBits, DstFormat::kGShift>(extractComponentSSE2<SrcFormat::kGBits, SrcFormat::kGShift>(color))),
+		insertComponentSSE2<DstFormat::kBBits, DstFormat::kBShift>(extractComponentSSE2<SrcFormat::kBBits, SrcFormat::kBShift>(color)));
+
+	if (DstFormat::kABits != 0) {
+		if (SrcFormat::kABits == 0)
+			result = _mm_or_si128(result, _mm_set1_epi32((0xFF >> (8 - DstFormat::kABits)) << DstFormat::kAShift));
+		else
+			result = _mm_or_si128(result, insertComponentSSE2<DstFormat::kABits, DstFormat::kAShift>(extractComponentSSE2<SrcFormat::kABits, SrcFormat::kAShift>(color)));
+	}
+	return result;
+}
+
+/** Convert eight pixels. All of them are read before any is written. */
+template<typename SrcFormat, typename DstFormat>
+inline void convertFixed8SSE2(typename DstFormat::PixelType *dst, const typename SrcFormat::PixelType *src) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lo, hi;
+	if (sizeof(typename SrcFormat::PixelType) == 2) {
+		const __m128i colors = _mm_loadu_si128((const __m128i *)src);
+		lo = _mm_unpacklo_epi16(colors, zero);
+		hi = _mm_unpackhi_epi16(colors, zero);
+	} else {
+		lo = _mm_loadu_si128((const __m128i *)src);
+		hi = _mm_loadu_si128((const __m128i *)src + 1);
+	}
+
+	lo = convertFixedSSE2<SrcFormat, DstFormat>(lo);
+	hi = convertFixedSSE2<SrcFormat, DstFormat>(hi);
+
+	if (sizeof(typename DstFormat::PixelType) == 2) {
+		// Sign extend the 16 bit values, so packing does not saturate them
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+	} else {
+		_mm_storeu_si128((__m128i *)dst, lo);
+		_mm_storeu_si128((__m128i *)dst + 1, hi);
+	}
+}
+
+#endif
+
+template<typename SrcFormat, typename DstFormat, bool backward>
+void crossBlitFixedLogic(byte *dst, const byte *src,
+                         const uint dstPitch, const uint srcPitch,
+                         const uint w, const uint h) {
+	typedef typename SrcFormat::PixelType SrcPixel;
+	typedef typename DstFormat::PixelType DstPixel;
+
+	for (uint i = 0; i < h; ++i) {
+		const uint y = backward ? h - 1 - i : i;
+		DstPixel *dstRow = (DstPixel *)(dst + y * dstPitch);
+		const SrcPixel *srcRow = (const SrcPixel *)(src + y * srcPitch);
+
+		if (backward) {
+			uint x = w;
+#ifdef GRAPHICS_CONVERSION_USE_SSE2
+			for (; x >= 8; x -= 8)
+				convertFixed8SSE2<SrcFormat, DstFormat>(dstRow + x - 8, srcRow + x - 8);
+#endif
+			while (x-- > 0)
+				dstRow[x] = convertFixed<SrcFormat, DstFormat>(srcRow[x]);
+		} else {
+			uint x = 0;
+#ifdef GRAPHICS_CONVERSION_USE_SSE2
+			for (; x + 8 <= w; x += 8)
+				convertFixed8SSE2<SrcFormat, DstFormat>(dstRow + x, srcRow + x);
+#endif
+			for (; x < w; ++x)
+				dstRow[x] = convertFixed<SrcFormat, DstFormat>(srcRow[x]);
+		}
+	}
+}
+
+template<typename SrcFormat, typename DstFormat>
+inline bool crossBlitFixedTo(byte *dst, const byte *src,
+                             const uint dstPitch, const uint srcPitch,
+                             const uint w, const uint h,
+                             const PixelFormat &dstFmt) {
+	if (!DstFormat::matches(dstFmt))
+		return false;
+
+	// Like in crossBlit(), converting to larger pixels runs backwards so
+	// that it works in place
+	const bool backward = sizeof(typename DstFormat::PixelType) > sizeof(typename SrcFormat::PixelType);
+	crossBlitFixedLogic<SrcFormat, DstFormat, backward>(dst, src, dstPitch, srcPitch, w, h);
+	return true;
+}
+
+template<typename SrcFormat>
+inline bool crossBlitFixedFrom(byte *dst, const byte *src,
+                               const uint dstPitch, const uint srcPitch,
+                               const uint w, const uint h,
+                               const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	if (!SrcFormat::matches(srcFmt))
+		return false;
+
+	return crossBlitFixedTo<SrcFormat, FormatRGB565>(dst, src, dstPitch, srcPitch, w, h, dstFmt) ||
+	       crossBlitFixedTo<SrcFormat, FormatRGB555>(dst, src, dstPitch, srcPitch, w, h, dstFmt) ||
+	       crossBlitFixedTo<SrcFormat, FormatARGB8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt) ||
+	       crossBlitFixedTo<SrcFormat, FormatRGBA8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt) ||
+	       crossBlitFixedTo<SrcFormat, FormatABGR8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt) ||
+	       crossBlitFixedTo<SrcFormat, FormatBGRA8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt);
+}
+
+/**
+ * Blit with a specialized converter if both formats are among the common
+ * ones above. Returns false if there is none.
+ */
+bool crossBlitFixed(byte *dst, const byte *src,
+                    const uint dstPitch, const uint srcPitch,
+                    const uint w, const uint h,
+                    const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	return crossBlitFixedFrom<FormatRGB565>(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt) ||
+	       crossBlitFixedFrom<FormatRGB555>(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt) ||
+	       crossBlitFixedFrom<FormatARGB8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt) ||
+	       crossBlitFixedFrom<FormatRGBA8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt) ||
+	       crossBlitFixedFrom<FormatABGR8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt) ||
+	       crossBlitFixedFrom<FormatBGRA8888>(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+}
+
 } // End of anonymous namespace
 
 // Function to blit a rect from one color format to another
@@ -134,6 +330,10 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+	// Common pairs of formats have specialized converters
+	if (crossBlitFixed(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt))
+		return true;
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -177,6 +377,54 @@ bool crossBlit(byte *dst, const byte *src,
 
 namespace {
 
+template<typename DstColor>
+void crossBlitMapLogic(byte *dst, const byte *src,
+                       const uint dstPitch, const uint srcPitch,
+                       const uint w, const uint h, const uint32 *map) {
+	// Go from bottom right to top left, so that this works in place
+	for (uint y = h; y-- > 0;) {
+		DstColor *dstRow = (DstColor *)(dst + y * dstPitch);
+		const byte *srcRow = src + y * srcPitch;
+		for (uint x = w; x-- > 0;)
+			dstRow[x] = map[srcRow[x]];
+	}
+}
+
+void crossBlitMapLogic3Bpp(byte *dst, const byte *src,
+                           const uint dstPitch, const uint srcPitch,
+                           const uint w, const uint h, const uint32 *map) {
+	for (uint y = h; y-- > 0;) {
+		byte *dstRow = dst + y * dstPitch;
+		const byte *srcRow = src + y * srcPitch;
+		for (uint x = w; x-- > 0;)
+			WRITE_UINT24(dstRow + x * 3, map[srcRow[x]]);
+	}
+}
+
+} // End of anonymous namespace
+
+bool crossBlitMap(byte *dst, const byte *src,
+                  const uint dstPitch, const uint srcPitch,
+                  const uint w, const uint h,
+                  const uint bytesPerPixel, const uint32 *map) {
+	switch (bytesPerPixel) {
+	case 2:
+		crossBlitMapLogic<uint16>(dst, src, dstPitch, srcPitch, w, h, map);
+		break;
+	case 3:
+		crossBlitMapLogic3Bpp(dst, src, dstPitch, srcPitch, w, h, map);
+		break;
+	case 4:
+		crossBlitMapLogic<uint32>(dst, src, dstPitch, srcPitch, w, h, map);
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+namespace {
+
 template <typename Size>
 void scaleNN(byte *dst, const byte *src,
                const uint dstPitch, const uint srcPitch,
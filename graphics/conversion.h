@@ -88,6 +88,30 @@ bool crossBlit(byte *dst, const byte *src,
                const uint w, const uint h,
                const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt);
 
+/**
+ * Blits a rectangle from a paletted format to another format, by looking
+ * up every pixel in a map.
+ *
+ * @param dst			the buffer which will recieve the converted graphics data
+ * @param src			the buffer containing the original graphics data
+ * @param dstPitch		width in bytes of one full line of the dest buffer
+ * @param srcPitch		width in bytes of one full line of the source buffer
+ * @param w				the width of the graphics data
+ * @param h				the height of the graphics data
+ * @param bytesPerPixel	the number of bytes per pixel of the destination
+ * @param map			the colors of the palette entries in the destination
+ *						format, at least up to the highest one in the source
+ * @return				true if conversion completes successfully,
+ *						false if there is an error.
+ *
+ * @note This can convert a surface in place, with the same constraints
+ *       as crossBlit().
+ */
+bool crossBlitMap(byte *dst, const byte *src,
+                  const uint dstPitch, const uint srcPitch,
+                  const uint w, const uint h,
+                  const uint bytesPerPixel, const uint32 *map);
+
 bool scaleBlit(byte *dst, const byte *src,
                const uint dstPitch, const uint srcPitch,
                const uint dstW, const uint dstH,
@@ -31,6 +31,7 @@
 #include "graphics/font.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/encoding.h"
 #include "common/file.h"
 #include "common/config-manager.h"
@@ -87,6 +88,74 @@ inline int divRoundToNearest(int dividend, int divisor) {
 	return (dividend + (divisor / 2)) / divisor;
 }
 
+/**
+ * Keys of the entries of a bounded cache, ordered by when they were last
+ * used. Every entry has a fixed slot, so the cache can refer to it.
+ */
+class LRUList {
+public:
+	enum { kNoSlot = 0xFFFFFFFF };
+
+	LRUList() : _newest(kNoSlot), _oldest(kNoSlot) {}
+
+	uint size() const { return _keys.size(); }
+
+	/** Add a new key as the most recently used one, and return its slot. */
+	uint add(uint32 key) {
+		const uint slot = _keys.size();
+		_keys.push_back(key);
+		_newer.push_back(kNoSlot);
+		_older.push_back(kNoSlot);
+		link(slot);
+		return slot;
+	}
+
+	/** Mark the key in the given slot as the most recently used one. */
+	void touch(uint slot) {
+		if (slot == _newest)
+			return;
+		unlink(slot);
+		link(slot);
+	}
+
+	/** Return the slot of the least recently used key. */
+	uint oldest() const { return _oldest; }
+
+	uint32 getKey(uint slot) const { return _keys[slot]; }
+
+	/** Put another key into the given slot, as the most recently used one. */
+	void replace(uint slot, uint32 key) {
+		_keys[slot] = key;
+		touch(slot);
+	}
+
+private:
+	void link(uint slot) {
+		_newer[slot] = kNoSlot;
+		_older[slot] = _newest;
+		if (_newest != kNoSlot)
+			_newer[_newest] = slot;
+		else
+			_oldest = slot;
+		_newest = slot;
+	}
+
+	void unlink(uint slot) {
+		if (_newer[slot] != kNoSlot)
+			_older[_newer[slot]] = _older[slot];
+		else
+			_newest = _older[slot];
+		if (_older[slot] != kNoSlot)
+			_newer[_older[slot]] = _newer[slot];
+		else
+			_oldest = _newer[slot];
+	}
+
+	Common::Array<uint32> _keys;
+	Common::Array<uint> _newer, _older;
+	uint _newest, _oldest;
+};
+
 } // End of anonymous namespace
 
 class TTFLibrary : public Common::Singleton<TTFLibrary> {
@@ -168,17 +237,50 @@ private:
 	int _ascent, _descent;
 
 	struct Glyph {
+		Glyph() : xOffset(0), yOffset(0), advance(0), slot(0), lateSlot(LRUList::kNoSlot) {}
+
 		Surface image;
 		int xOffset, yOffset;
 		int advance;
 		FT_UInt slot;
+		/** Slot in _lateGlyphs if the glyph was cached after loading */
+		uint lateSlot;
 	};
 
 	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
 	typedef Common::HashMap<uint32, Glyph> GlyphCache;
 	mutable GlyphCache _glyphs;
 	bool _allowLateCaching;
-	void assureCached(uint32 chr) const;
+	const Glyph *findGlyph(uint32 chr) const;
+
+	/**
+	 * Characters cached after loading, by when they were last drawn. Glyphs
+	 * which could not be rendered are cached too, with a zero slot, so they
+	 * do not get rendered again every time they are drawn.
+	 */
+	mutable LRUList _lateGlyphs;
+
+	/**
+	 * Maximum number of characters cached after loading. Beyond that, the
+	 * least recently used one is dropped for every new one.
+	 */
+	static const uint kMaxLateGlyphs = 2048;
+
+	struct KerningPair {
+		int offset;
+		uint lruSlot;
+	};
+
+	/** Kerning offsets of the glyph pairs looked up lately, keyed by both glyph slots. */
+	typedef Common::HashMap<uint32, KerningPair> KerningCache;
+	mutable KerningCache _kerningPairs;
+	mutable LRUList _kerningPairUses;
+
+	/** Maximum number of kerning pairs cached, handled like kMaxLateGlyphs. */
+	static const uint kMaxKerningPairs = 4096;
+
+	mutable uint _glyphLookups;
+	mutable uint _glyphRenders;
 
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
@@ -197,11 +299,15 @@ private:
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
       _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-      _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false) {
+      _hasKerning(false), _allowLateCaching(false), _glyphLookups(0), _glyphRenders(0),
+      _fakeBold(false), _fakeItalic(false) {
 }
 
 TTFFont::~TTFFont() {
 	if (_initialized) {
+		debug(5, "TTFFont: %u glyph lookups, %u glyphs rendered after loading, %u kerning pairs cached",
+		      _glyphLookups, _glyphRenders, _kerningPairs.size());
+
 		g_ttf.closeFont(_face);
 
 		delete[] _ttfFile;
@@ -526,55 +632,59 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
-
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
+	const Glyph *glyph = findGlyph(left);
+	if (!glyph)
 		return 0;
-	}
+	const FT_UInt leftSlot = glyph->slot;
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
+	glyph = findGlyph(right);
+	if (!glyph)
 		return 0;
+	const FT_UInt rightSlot = glyph->slot;
+
+	// TrueType fonts have at most 65535 glyphs, so both slots fit in the key
+	const uint32 pair = (leftSlot << 16) | (rightSlot & 0xFFFF);
+	KerningCache::const_iterator kerningEntry = _kerningPairs.find(pair);
+	if (kerningEntry != _kerningPairs.end()) {
+		_kerningPairUses.touch(kerningEntry->_value.lruSlot);
+		return kerningEntry->_value.offset;
 	}
 
-	if (!leftGlyph || !rightGlyph)
-		return 0;
-
 	FT_Vector kerningVector;
-	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	FT_Get_Kerning(_face, leftSlot, rightSlot, FT_KERNING_DEFAULT, &kerningVector);
+
+	KerningPair newPair;
+	newPair.offset = kerningVector.x / 64;
+	if (_kerningPairUses.size() < kMaxKerningPairs) {
+		newPair.lruSlot = _kerningPairUses.add(pair);
+	} else {
+		newPair.lruSlot = _kerningPairUses.oldest();
+		_kerningPairs.erase(_kerningPairUses.getKey(newPair.lruSlot));
+		_kerningPairUses.replace(newPair.lruSlot, pair);
+	}
+	_kerningPairs[pair] = newPair;
+	return newPair.offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
+		const int xOffset = glyph->xOffset;
+		const int yOffset = glyph->yOffset;
+		const Graphics::Surface &image = glyph->image;
 		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
 	}
 }
@@ -618,12 +728,11 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyphEntry = findGlyph(chr);
+	if (!glyphEntry)
 		return;
 
-	const Glyph &glyph = glyphEntry->_value;
+	const Glyph &glyph = *glyphEntry;
 
 	x += glyph.xOffset;
 	y += glyph.yOffset;
@@ -811,15 +920,40 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	return true;
 }
 
-void TTFFont::assureCached(uint32 chr) const {
-	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
-		return;
+const TTFFont::Glyph *TTFFont::findGlyph(uint32 chr) const {
+	_glyphLookups++;
+
+	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry != _glyphs.end()) {
+		if (glyphEntry->_value.lateSlot != LRUList::kNoSlot)
+			_lateGlyphs.touch(glyphEntry->_value.lateSlot);
+		return glyphEntry->_value.slot ? &glyphEntry->_value : nullptr;
 	}
 
+	if (!chr || !_allowLateCaching)
+		return nullptr;
+
+	_glyphRenders++;
 	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
+	if (!cacheGlyph(newGlyph, chr))
+		newGlyph.slot = 0;
+
+	// Fonts covering many characters, like CJK ones, would otherwise keep
+	// every glyph ever drawn. Once too many got cached, drop the least
+	// recently used one. The ISO-8859-1 glyphs loaded up front are kept.
+	if (_lateGlyphs.size() < kMaxLateGlyphs) {
+		newGlyph.lateSlot = _lateGlyphs.add(chr);
+	} else {
+		newGlyph.lateSlot = _lateGlyphs.oldest();
+		const uint32 oldest = _lateGlyphs.getKey(newGlyph.lateSlot);
+		_glyphs[oldest].image.free();
+		_glyphs.erase(oldest);
+		_lateGlyphs.replace(newGlyph.lateSlot, chr);
 	}
+
+	Glyph &glyph = _glyphs[chr];
+	glyph = newGlyph;
+	return glyph.slot ? &glyph : nullptr;
 }
 
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping, bool stemDarkening) {
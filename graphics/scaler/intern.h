@@ -26,6 +26,14 @@
 #include "common/scummsys.h"
 #include "graphics/colormasks.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define SCALER_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define SCALER_USE_NEON
+#include <arm_neon.h>
+#endif
+
 
 /**
  * Interpolate two 16 bit pixel *pairs* at once with equal weights 1.
@@ -524,4 +532,88 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+/** Maximum number of pixels hqPatterns() handles at once. */
+static const int kHQPatternChunk = 64;
+
+/**
+ * Compute the patterns used by the hq scaler family for a run of pixels.
+ * Bit n of a pattern is set when the n-th neighbor of the pixel, in the
+ * order w1, w2, w3, w4, w6, w7, w8, w9 of the scalers, differs from it
+ * according to diffYUV().
+ *
+ * The YUV value of each source pixel only gets looked up once, and the
+ * comparisons are done several pixels at once where SIMD is available.
+ *
+ * Only the pattern detection is vectorized: the per-pattern interpolations
+ * of HQ2x and HQ3x are still plain C++. This is not a replacement for
+ * hq2x_i386.asm and hq3x_i386.asm, which remain the faster path on 32 bit
+ * x86 builds with NASM; porting them is out of scope here.
+ *
+ * @param p        Pointer at the first center pixel.
+ * @param nextline Distance between two rows, in pixels.
+ * @param count    Number of pixels, at most kHQPatternChunk.
+ * @param rgbToYuv Table of the YUV values of all 16 bit colors.
+ * @param patterns Receives count patterns.
+ */
+static inline void hqPatterns(const uint16 *p, uint32 nextline, int count, const uint32 *rgbToYuv, uint8 *patterns) {
+	uint32 yuv[3][kHQPatternChunk + 2];
+	for (int row = 0; row < 3; ++row) {
+		const uint16 *src = p + (row - 1) * (int)nextline - 1;
+		for (int i = 0; i < count + 2; ++i)
+			yuv[row][i] = rgbToYuv[src[i]];
+	}
+
+	// Position of each neighbor in yuv, relative to the pixel left of the row above
+	static const int neighbors[8][2] = {
+		{ 0, 0 }, { 0, 1 }, { 0, 2 },
+		{ 1, 0 },           { 1, 2 },
+		{ 2, 0 }, { 2, 1 }, { 2, 2 }
+	};
+
+	int i = 0;
+#if defined(SCALER_USE_SSE2)
+	// diffYUV() is a comparison of the absolute difference of each byte with
+	// a threshold. The unused top byte never counts.
+	const __m128i threshold = _mm_set1_epi32((int)0xFF300706);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= count; i += 4) {
+		const __m128i center = _mm_loadu_si128((const __m128i *)&yuv[1][i + 1]);
+		__m128i pattern = zero;
+		for (int n = 0; n < 8; ++n) {
+			const __m128i other = _mm_loadu_si128((const __m128i *)&yuv[neighbors[n][0]][i + neighbors[n][1]]);
+			const __m128i diff = _mm_or_si128(_mm_subs_epu8(center, other), _mm_subs_epu8(other, center));
+			const __m128i similar = _mm_cmpeq_epi32(_mm_subs_epu8(diff, threshold), zero);
+			pattern = _mm_or_si128(pattern, _mm_andnot_si128(similar, _mm_set1_epi32(1 << n)));
+		}
+		pattern = _mm_packs_epi32(pattern, pattern);
+		const uint32 packed = _mm_cvtsi128_si32(_mm_packus_epi16(pattern, pattern));
+		memcpy(patterns + i, &packed, 4);
+	}
+#elif defined(SCALER_USE_NEON)
+	const uint8x16_t threshold = vreinterpretq_u8_u32(vdupq_n_u32(0xFF300706));
+	for (; i + 4 <= count; i += 4) {
+		const uint8x16_t center = vld1q_u8((const uint8 *)&yuv[1][i + 1]);
+		uint32x4_t pattern = vdupq_n_u32(0);
+		for (int n = 0; n < 8; ++n) {
+			const uint8x16_t other = vld1q_u8((const uint8 *)&yuv[neighbors[n][0]][i + neighbors[n][1]]);
+			const uint32x4_t exceeded = vreinterpretq_u32_u8(vcgtq_u8(vabdq_u8(center, other), threshold));
+			pattern = vorrq_u32(pattern, vandq_u32(vtstq_u32(exceeded, exceeded), vdupq_n_u32(1 << n)));
+		}
+		uint32 lanes[4];
+		vst1q_u32(lanes, pattern);
+		for (int j = 0; j < 4; ++j)
+			patterns[i + j] = lanes[j];
+	}
+#endif
+
+	for (; i < count; ++i) {
+		int pattern = 0;
+		for (int n = 0; n < 8; ++n) {
+			if (diffYUV(yuv[1][i + 1], yuv[neighbors[n][0]][i + neighbors[n][1]]))
+				pattern |= 1 << n;
+		}
+		patterns[i] = pattern;
+	}
+}
+
 #endif
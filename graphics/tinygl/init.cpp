@@ -234,6 +234,7 @@ void glInit(void *zbuffer1, int textureSize) {
 	c->_drawCallAllocator[0].initialize(kDrawCallMemory);
 	c->_drawCallAllocator[1].initialize(kDrawCallMemory);
 	c->_enableDirtyRectangles = true;
+	c->_dirtyRectBandHeight = TGL_DIRTY_RECT_BAND_HEIGHT;
 
 	Graphics::Internal::tglBlitResetScissorRect();
 }
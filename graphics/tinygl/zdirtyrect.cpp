@@ -156,51 +156,53 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 		(*it).rectangle.bottom++;
 	}
 
-	// Merge coalesce dirty rects.
-	bool restartMerge;
-	do {
-		restartMerge = false;
-		for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-			for (RectangleIterator it2 = rectangles.begin(); it2 != rectangles.end();) {
-				if (it1 != it2) {
-					if ((*it1).rectangle.intersects((*it2).rectangle)) {
-						(*it1).rectangle.extend((*it2).rectangle);
-						it2 = rectangles.erase(it2);
-						restartMerge = true;
-					} else {
-						++it2;
-					}
+	// Merge coalesce dirty rects. Every rectangle absorbs all the already
+	// merged ones it intersects before being added to them. Since growing
+	// can make it intersect more of them, this is repeated until it stops
+	// growing. The merged rectangles thus never intersect each other, which
+	// also means none of them contains another.
+	Common::List<DirtyRectangle> mergedRectangles;
+	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
+		DirtyRectangle rectangle = *it1;
+		bool grown;
+		do {
+			grown = false;
+			for (RectangleIterator it2 = mergedRectangles.begin(); it2 != mergedRectangles.end();) {
+				if (rectangle.rectangle.intersects((*it2).rectangle)) {
+					rectangle.rectangle.extend((*it2).rectangle);
+					it2 = mergedRectangles.erase(it2);
+					grown = true;
 				} else {
 					++it2;
 				}
 			}
-		}
-	} while(restartMerge);
-
-	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-		RectangleIterator it2 = it1;
-		it2++;
-		while (it2 != rectangles.end()) {
-			if ((*it1).rectangle.contains((*it2).rectangle)) {
-				it2 = rectangles.erase(it2);
-			} else {
-				++it2;
-			}
-		}
+		} while (grown);
+		mergedRectangles.push_back(rectangle);
 	}
+	rectangles = mergedRectangles;
 
 	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
 		(*it1).rectangle.clip(c->renderRect);
 	}
 
 	if (!rectangles.empty()) {
-		// Execute draw calls.
-		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
-			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+		// Execute draw calls, one horizontal band of the screen after the
+		// other, or in a single pass if no band height is set. The pixels of
+		// a band only depend on the draw calls touching it, so this gives
+		// the same image as redrawing whole rectangles.
+		const Common::Rect &renderRect = c->renderRect;
+		const int bandHeight = c->_dirtyRectBandHeight > 0 ? c->_dirtyRectBandHeight : renderRect.height();
+		for (int bandTop = renderRect.top; bandTop < renderRect.bottom; bandTop += bandHeight) {
+			const Common::Rect band(renderRect.left, bandTop, renderRect.right, MIN<int>(bandTop + bandHeight, renderRect.bottom));
+			for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				if (!drawCallRegion.intersects(band))
+					continue;
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle.findIntersectingRect(band);
+					if (!dirtyRegion.isEmpty() && dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(dirtyRegion, true);
+					}
 				}
 			}
 		}
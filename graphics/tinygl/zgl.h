@@ -73,6 +73,11 @@ enum {
 #define VERTEX_HASH_SIZE 1031
 
 #define MAX_DISPLAY_LISTS 1024
+
+// Height of the screen bands the dirty rectangles are redrawn in, 0 to
+// redraw whole rectangles. As the bands are drawn one after the other,
+// splitting only adds overhead for now.
+#define TGL_DIRTY_RECT_BAND_HEIGHT 0
 #define OP_BUFFER_MAX_SIZE 512
 
 #define TGL_OFFSET_FILL    0x1
@@ -387,6 +392,7 @@ struct GLContext {
 	Common::Rect _scissorRect;
 
 	bool _enableDirtyRectangles;
+	int _dirtyRectBandHeight; // 0 redraws each dirty rectangle at once
 
 	// blit test
 	Common::List<Graphics::BlitImage *> _blitImages;
@@ -38,6 +38,14 @@
 #include "graphics/transparent_surface.h"
 #include "graphics/transform_tools.h"
 
+#if defined(SCUMM_LITTLE_ENDIAN) && (defined(__SSE2__) || defined(_M_X64))
+#define TRANSPARENT_SURFACE_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define TRANSPARENT_SURFACE_USE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Graphics {
 
 static const int kBModShift = 0;//img->format.bShift;
@@ -82,6 +90,296 @@ TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Sur
 	}
 }
 
+/*
+ * Vectorized row kernels for the blitters below. Each of them handles the
+ * longest prefix of a row which fits into whole vectors and returns its
+ * length in pixels, the rest of the row is left to the scalar code. They
+ * produce exactly the same results as the scalar code, including the
+ * places where its intermediate results wrap around. The source pixels
+ * must not be flipped horizontally, i.e. inStep has to be 4.
+ */
+#if defined(TRANSPARENT_SURFACE_USE_SSE2)
+
+// The SSE2 kernels rely on the little endian channel order A, B, G, R
+
+static inline __m128i selectSSE2(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** Spread the alpha of the two unpacked pixels in x to all their channels. */
+static inline __m128i broadcastAlphaSSE2(__m128i x) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0), 0);
+}
+
+static uint32 blitOpaqueRow(const byte *in, byte *out, uint32 width) {
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4)
+		_mm_storeu_si128((__m128i *)(out + j * 4), _mm_or_si128(_mm_loadu_si128((const __m128i *)(in + j * 4)), alpha));
+	return j;
+}
+
+static uint32 blitBinaryRow(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i keep = _mm_cmpeq_epi32(_mm_and_si128(src, alpha), zero);
+		_mm_storeu_si128((__m128i *)(out + j * 4), selectSSE2(keep, dst, _mm_or_si128(src, alpha)));
+	}
+	return j;
+}
+
+static inline __m128i alphaBlendSSE2(__m128i s, __m128i d) {
+	const __m128i a = broadcastAlphaSSE2(s);
+	const __m128i na = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, na)), 8);
+}
+
+static uint32 blitAlphaBlendRow(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i keep = _mm_cmpeq_epi32(_mm_and_si128(src, alpha), zero);
+		const __m128i lo = alphaBlendSSE2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+		const __m128i hi = alphaBlendSSE2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+		_mm_storeu_si128((__m128i *)(out + j * 4), selectSSE2(keep, dst, _mm_or_si128(_mm_packus_epi16(lo, hi), alpha)));
+	}
+	return j;
+}
+
+/** Returns the tinted alpha of the two unpacked pixels in s, spread to all channels. */
+static inline __m128i tintedAlphaSSE2(__m128i s, __m128i ca) {
+	return _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(s), ca), 8);
+}
+
+static inline __m128i tintedAlphaBlendSSE2(__m128i s, __m128i d, __m128i ina, __m128i tint) {
+	const __m128i na = _mm_sub_epi16(_mm_set1_epi16(255), ina);
+	const __m128i faded = _mm_srli_epi16(_mm_mullo_epi16(d, na), 8);
+	const __m128i added = _mm_mulhi_epu16(_mm_mullo_epi16(s, ina), tint);
+	return _mm_and_si128(_mm_add_epi16(faded, added), _mm_set1_epi16(0xFF));
+}
+
+static uint32 blitAlphaBlendRow(const byte *in, byte *out, uint32 width, uint32 color) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	const __m128i ca = _mm_set1_epi16((color >> kAModShift) & 0xFF);
+	const __m128i tint = _mm_set_epi16((color >> kRModShift) & 0xFF, (color >> kGModShift) & 0xFF, (color >> kBModShift) & 0xFF, 0,
+	                                   (color >> kRModShift) & 0xFF, (color >> kGModShift) & 0xFF, (color >> kBModShift) & 0xFF, 0);
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i inaLo = tintedAlphaSSE2(srcLo, ca), inaHi = tintedAlphaSSE2(srcHi, ca);
+		const __m128i keep = _mm_packs_epi16(_mm_cmpeq_epi16(inaLo, zero), _mm_cmpeq_epi16(inaHi, zero));
+		const __m128i lo = tintedAlphaBlendSSE2(srcLo, _mm_unpacklo_epi8(dst, zero), inaLo, tint);
+		const __m128i hi = tintedAlphaBlendSSE2(srcHi, _mm_unpackhi_epi8(dst, zero), inaHi, tint);
+		_mm_storeu_si128((__m128i *)(out + j * 4), selectSSE2(keep, dst, _mm_or_si128(_mm_packus_epi16(lo, hi), alpha)));
+	}
+	return j;
+}
+
+static uint32 blitAdditiveBlendRow(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(srcLo, broadcastAlphaSSE2(srcLo)), 8);
+		const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(srcHi, broadcastAlphaSSE2(srcHi)), 8);
+		_mm_storeu_si128((__m128i *)(out + j * 4), _mm_adds_epu8(dst, _mm_andnot_si128(alpha, _mm_packus_epi16(lo, hi))));
+	}
+	return j;
+}
+
+static inline __m128i tintedAdditiveSSE2(__m128i s, __m128i ina, __m128i tint, __m128i plain) {
+	const __m128i x = _mm_mullo_epi16(s, ina);
+	return selectSSE2(plain, _mm_srli_epi16(x, 8), _mm_mulhi_epu16(x, tint));
+}
+
+static uint32 blitAdditiveBlendRow(const byte *in, byte *out, uint32 width, uint32 color) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	const __m128i ca = _mm_set1_epi16((color >> kAModShift) & 0xFF);
+	const __m128i tint = _mm_set_epi16((color >> kRModShift) & 0xFF, (color >> kGModShift) & 0xFF, (color >> kBModShift) & 0xFF, 0,
+	                                   (color >> kRModShift) & 0xFF, (color >> kGModShift) & 0xFF, (color >> kBModShift) & 0xFF, 0);
+	// Channels with a tint of 255 are computed with less precision
+	const __m128i plain = _mm_cmpeq_epi16(tint, _mm_set1_epi16(255));
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i lo = tintedAdditiveSSE2(srcLo, tintedAlphaSSE2(srcLo, ca), tint, plain);
+		const __m128i hi = tintedAdditiveSSE2(srcHi, tintedAlphaSSE2(srcHi, ca), tint, plain);
+		_mm_storeu_si128((__m128i *)(out + j * 4), _mm_adds_epu8(dst, _mm_andnot_si128(alpha, _mm_packus_epi16(lo, hi))));
+	}
+	return j;
+}
+
+static uint32 blitSubtractiveBlendRow(const byte *in, byte *out, uint32 width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(0xFF);
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i lo = _mm_mulhi_epu16(_mm_mullo_epi16(srcLo, _mm_unpacklo_epi8(dst, zero)), broadcastAlphaSSE2(srcLo));
+		const __m128i hi = _mm_mulhi_epu16(_mm_mullo_epi16(srcHi, _mm_unpackhi_epi8(dst, zero)), broadcastAlphaSSE2(srcHi));
+		_mm_storeu_si128((__m128i *)(out + j * 4), _mm_sub_epi8(dst, _mm_andnot_si128(alpha, _mm_packus_epi16(lo, hi))));
+	}
+	return j;
+}
+
+#elif defined(TRANSPARENT_SURFACE_USE_NEON)
+
+// The NEON kernels deinterleave the channels, so they work for both byte orders
+
+/** Returns (x * y) >> 16 for each lane. */
+static inline uint16x8_t mulHighNEON(uint16x8_t x, uint16x8_t y) {
+	const uint32x4_t lo = vmull_u16(vget_low_u16(x), vget_low_u16(y));
+	const uint32x4_t hi = vmull_u16(vget_high_u16(x), vget_high_u16(y));
+	return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+}
+
+static uint32 blitOpaqueRow(const byte *in, byte *out, uint32 width) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		uint8x8x4_t pixels = vld4_u8(in + j * 4);
+		pixels.val[kAIndex] = vdup_n_u8(0xFF);
+		vst4_u8(out + j * 4, pixels);
+	}
+	return j;
+}
+
+static uint32 blitBinaryRow(const byte *in, byte *out, uint32 width) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = vld4_u8(in + j * 4);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t keep = vceq_u8(src.val[kAIndex], vdup_n_u8(0));
+		for (int c = 0; c < 4; ++c) {
+			if (c != kAIndex)
+				dst.val[c] = vbsl_u8(keep, dst.val[c], src.val[c]);
+		}
+		dst.val[kAIndex] = vorr_u8(dst.val[kAIndex], vmvn_u8(keep));
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitAlphaBlendRow(const byte *in, byte *out, uint32 width) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = vld4_u8(in + j * 4);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t a = src.val[kAIndex];
+		const uint8x8_t na = vmvn_u8(a);
+		const uint8x8_t keep = vceq_u8(a, vdup_n_u8(0));
+		for (int c = 0; c < 4; ++c) {
+			if (c != kAIndex) {
+				const uint8x8_t blended = vshrn_n_u16(vmlal_u8(vmull_u8(src.val[c], a), dst.val[c], na), 8);
+				dst.val[c] = vbsl_u8(keep, dst.val[c], blended);
+			}
+		}
+		dst.val[kAIndex] = vorr_u8(dst.val[kAIndex], vmvn_u8(keep));
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitAlphaBlendRow(const byte *in, byte *out, uint32 width, uint32 color) {
+	const uint8x8_t ca = vdup_n_u8((color >> kAModShift) & 0xFF);
+	uint16x8_t tint[4];
+	tint[kAIndex] = vdupq_n_u16(0);
+	tint[kRIndex] = vdupq_n_u16((color >> kRModShift) & 0xFF);
+	tint[kGIndex] = vdupq_n_u16((color >> kGModShift) & 0xFF);
+	tint[kBIndex] = vdupq_n_u16((color >> kBModShift) & 0xFF);
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = vld4_u8(in + j * 4);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t ina = vshrn_n_u16(vmull_u8(src.val[kAIndex], ca), 8);
+		const uint8x8_t na = vmvn_u8(ina);
+		const uint8x8_t keep = vceq_u8(ina, vdup_n_u8(0));
+		for (int c = 0; c < 4; ++c) {
+			if (c != kAIndex) {
+				const uint8x8_t faded = vshrn_n_u16(vmull_u8(dst.val[c], na), 8);
+				const uint8x8_t added = vmovn_u16(mulHighNEON(vmull_u8(src.val[c], ina), tint[c]));
+				dst.val[c] = vbsl_u8(keep, dst.val[c], vadd_u8(faded, added));
+			}
+		}
+		dst.val[kAIndex] = vorr_u8(dst.val[kAIndex], vmvn_u8(keep));
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitAdditiveBlendRow(const byte *in, byte *out, uint32 width) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = vld4_u8(in + j * 4);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		for (int c = 0; c < 4; ++c) {
+			if (c != kAIndex)
+				dst.val[c] = vqadd_u8(dst.val[c], vshrn_n_u16(vmull_u8(src.val[c], src.val[kAIndex]), 8));
+		}
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitAdditiveBlendRow(const byte *in, byte *out, uint32 width, uint32 color) {
+	const uint8x8_t ca = vdup_n_u8((color >> kAModShift) & 0xFF);
+	uint32 tint[4];
+	tint[kAIndex] = 0;
+	tint[kRIndex] = (color >> kRModShift) & 0xFF;
+	tint[kGIndex] = (color >> kGModShift) & 0xFF;
+	tint[kBIndex] = (color >> kBModShift) & 0xFF;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = vld4_u8(in + j * 4);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t ina = vshrn_n_u16(vmull_u8(src.val[kAIndex], ca), 8);
+		for (int c = 0; c < 4; ++c) {
+			if (c == kAIndex)
+				continue;
+			const uint16x8_t x = vmull_u8(src.val[c], ina);
+			// Channels with a tint of 255 are computed with less precision
+			const uint8x8_t added = (tint[c] == 255) ? vshrn_n_u16(x, 8) : vmovn_u16(mulHighNEON(x, vdupq_n_u16(tint[c])));
+			dst.val[c] = vqadd_u8(dst.val[c], added);
+		}
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitSubtractiveBlendRow(const byte *in, byte *out, uint32 width) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = vld4_u8(in + j * 4);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint16x8_t a = vmovl_u8(src.val[kAIndex]);
+		for (int c = 0; c < 4; ++c) {
+			if (c != kAIndex)
+				dst.val[c] = vsub_u8(dst.val[c], vmovn_u16(mulHighNEON(vmull_u8(src.val[c], dst.val[c]), a)));
+		}
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+#endif
+
 /**
  * Optimized version of doBlit to be used w/opaque blitting (no alpha).
  */
@@ -93,8 +391,14 @@ void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		memcpy(out, in, width * 4);
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+		j = blitOpaqueRow(in, out, width);
+		in += j * 4;
+		out += j * 4;
+#endif
+		memcpy(out, in, (width - j) * 4);
+		for (; j < width; j++) {
 			out[kAIndex] = 0xFF;
 			out += 4;
 		}
@@ -114,7 +418,15 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+		if (inStep == 4) {
+			j = blitBinaryRow(in, out, width);
+			in += j * 4;
+			out += j * 4;
+		}
+#endif
+		for (; j < width; j++) {
 			uint32 pix = *(uint32 *)in;
 			int a = in[kAIndex];
 
@@ -150,7 +462,15 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+			if (inStep == 4) {
+				j = blitAlphaBlendRow(in, out, width);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kAIndex] = 255;
@@ -175,7 +495,15 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+			if (inStep == 4) {
+				j = blitAlphaBlendRow(in, out, width, color);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -211,7 +539,15 @@ void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+			if (inStep == 4) {
+				j = blitAdditiveBlendRow(in, out, width);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) + out[kRIndex], 255);
@@ -235,7 +571,15 @@ void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+			if (inStep == 4) {
+				j = blitAdditiveBlendRow(in, out, width, color);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -278,7 +622,15 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			uint32 j = 0;
+#if defined(TRANSPARENT_SURFACE_USE_SSE2) || defined(TRANSPARENT_SURFACE_USE_NEON)
+			if (inStep == 4) {
+				j = blitSubtractiveBlendRow(in, out, width);
+				in += j * 4;
+				out += j * 4;
+			}
+#endif
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * out[kRIndex]) * in[kAIndex] >> 16), 0);
@@ -794,6 +1146,88 @@ systems.
 
 struct tColorRGBA { byte r; byte g; byte b; byte a; };
 
+static inline int64 floorDiv(int64 n, int64 d) {
+	return (n >= 0) ? n / d : -((-n + d - 1) / d);
+}
+
+/**
+ * Narrow the span [x0, x1) down to the values of x for which
+ * lo <= a + x * b < hi holds.
+ */
+static void clipSpan(int64 a, int64 b, int64 lo, int64 hi, int &x0, int &x1) {
+	int64 first, end;
+	if (b > 0) {
+		first = -floorDiv(a - lo, b);
+		end = -floorDiv(a - hi, b);
+	} else if (b < 0) {
+		first = floorDiv(a - hi, -b) + 1;
+		end = floorDiv(a - lo, -b) + 1;
+	} else if (a >= lo && a < hi) {
+		return;
+	} else {
+		first = end = x0;
+	}
+
+	x0 = (int)MAX<int64>(x0, first);
+	x1 = (int)MAX<int64>(x0, MIN<int64>(x1, end));
+}
+
+/**
+ * Interpolate between the four source pixels around (ex, ey), which are
+ * the fractional parts of the source coordinates in 16.16 fixed point.
+ */
+static inline void interpolateBilinear(const tColorRGBA *sp, int pitch, int ex, int ey, tColorRGBA *pc) {
+	const tColorRGBA c00 = sp[0];
+	const tColorRGBA c01 = sp[1];
+	const tColorRGBA c10 = sp[pitch];
+	const tColorRGBA c11 = sp[pitch + 1];
+
+	int t1, t2;
+	t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
+	t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
+	pc->r = (((t2 - t1) * ey) >> 16) + t1;
+	t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
+	t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
+	pc->g = (((t2 - t1) * ey) >> 16) + t1;
+	t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
+	t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
+	pc->b = (((t2 - t1) * ey) >> 16) + t1;
+	t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
+	t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
+	pc->a = (((t2 - t1) * ey) >> 16) + t1;
+}
+
+#if defined(TRANSPARENT_SURFACE_USE_SSE2)
+
+/**
+ * Returns ((d * e) >> 16) for the 16 bit differences in the low half of d
+ * and a 16 bit unsigned weight e. The products need 32 bits, and SSE2 can
+ * only multiply those as signed 16 bit pairs, so e is split in its upper
+ * 15 and its lowest bit: d * e == 2 * d * (e >> 1) + d * (e & 1).
+ */
+static inline __m128i weightSSE2(__m128i d, int e) {
+	const __m128i pairs = _mm_unpacklo_epi16(_mm_add_epi16(d, d), d);
+	const __m128i weights = _mm_set1_epi32(((e & 1) << 16) | (e >> 1));
+	return _mm_srai_epi32(_mm_madd_epi16(pairs, weights), 16);
+}
+
+/** Same as interpolateBilinear(), with all four channels at once. */
+static inline void interpolateBilinearSSE2(const tColorRGBA *sp, int pitch, int ex, int ey, tColorRGBA *pc) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)sp), zero);
+	const __m128i bottom = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(sp + pitch)), zero);
+
+	// Low halves hold the left pixels, high halves the right ones
+	const __m128i t1 = _mm_add_epi32(weightSSE2(_mm_sub_epi16(_mm_unpackhi_epi64(top, top), top), ex), _mm_unpacklo_epi16(top, zero));
+	const __m128i t2 = _mm_add_epi32(weightSSE2(_mm_sub_epi16(_mm_unpackhi_epi64(bottom, bottom), bottom), ex), _mm_unpacklo_epi16(bottom, zero));
+	const __m128i t1Packed = _mm_packs_epi32(t1, t1);
+	const __m128i result = _mm_add_epi32(weightSSE2(_mm_sub_epi16(_mm_packs_epi32(t2, t2), t1Packed), ey), t1);
+
+	*(uint32 *)pc = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(result, result), zero));
+}
+
+#endif
+
 template <TFilteringMode filteringMode>
 TransparentSurface *TransparentSurface::rotoscaleT(const TransformStruct &transform) const {
 
@@ -828,8 +1262,7 @@ TransparentSurface *TransparentSurface::rotoscaleT(const TransformStruct &transf
 	int icosy = (int)(invCos * (65536.0f * kDefaultZoomY / transform._zoom.y));
 	int isiny = (int)(invSin * (65536.0f * kDefaultZoomY / transform._zoom.y));
 
-
-	bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
+	// TODO: Mirroring, see the comment in the RenderTicket ctor
 
 	int xd = (srcRect.left + transform._hotspot.x) << 16;
 	int yd = (srcRect.top + transform._hotspot.y) << 16;
@@ -838,68 +1271,36 @@ TransparentSurface *TransparentSurface::rotoscaleT(const TransformStruct &transf
 
 	int ax = -icosx * cx;
 	int ay = -isiny * cx;
-	int sw = srcW - 1;
-	int sh = srcH - 1;
 
-	tColorRGBA *pc = (tColorRGBA*)target->getBasePtr(0, 0);
+	// Bilinear filtering needs the right and lower neighbours as well
+	const int limitW = (filteringMode == FILTER_BILINEAR) ? srcW - 1 : srcW;
+	const int limitH = (filteringMode == FILTER_BILINEAR) ? srcH - 1 : srcH;
+	const int srcPitch = this->pitch / 4;
 
 	for (int y = 0; y < dstH; y++) {
 		int t = cy - y;
 		int sdx = ax + (isinx * t) + xd;
 		int sdy = ay - (icosy * t) + yd;
-		for (int x = 0; x < dstW; x++) {
-			int dx = (sdx >> 16);
-			int dy = (sdy >> 16);
-			if (flipx) {
-				dx = sw - dx;
-			}
-			if (flipy) {
-				dy = sh - dy;
-			}
 
+		// Only walk the part of the row which maps into the source
+		int x0 = 0, x1 = dstW;
+		clipSpan(sdx, icosx, 0, (int64)limitW << 16, x0, x1);
+		clipSpan(sdy, isiny, 0, (int64)limitH << 16, x0, x1);
+
+		sdx += icosx * x0;
+		sdy += isiny * x0;
+		tColorRGBA *pc = (tColorRGBA *)target->getBasePtr(x0, y);
+
+		for (int x = x0; x < x1; x++) {
+			const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(sdx >> 16, sdy >> 16);
 			if (filteringMode == FILTER_BILINEAR) {
-				if ((dx > -1) && (dy > -1) && (dx < sw) && (dy < sh)) {
-					const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-					tColorRGBA c00, c01, c10, c11, cswap;
-					c00 = *sp;
-					sp += 1;
-					c01 = *sp;
-					sp += (this->pitch / 4);
-					c11 = *sp;
-					sp -= 1;
-					c10 = *sp;
-					if (flipx) {
-						cswap = c00; c00=c01; c01=cswap;
-						cswap = c10; c10=c11; c11=cswap;
-					}
-					if (flipy) {
-						cswap = c00; c00=c10; c10=cswap;
-						cswap = c01; c01=c11; c11=cswap;
-					}
-					/*
-					* Interpolate colors
-					*/
-					int ex = (sdx & 0xffff);
-					int ey = (sdy & 0xffff);
-					int t1, t2;
-					t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
-					t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
-					pc->r = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
-					t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
-					pc->g = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
-					t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
-					pc->b = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
-					t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
-					pc->a = (((t2 - t1) * ey) >> 16) + t1;
-				}
+#if defined(TRANSPARENT_SURFACE_USE_SSE2)
+				interpolateBilinearSSE2(sp, srcPitch, sdx & 0xffff, sdy & 0xffff, pc);
+#else
+				interpolateBilinear(sp, srcPitch, sdx & 0xffff, sdy & 0xffff, pc);
+#endif
 			} else {
-				if ((dx >= 0) && (dy >= 0) && (dx < srcW) && (dy < srcH)) {
-					const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-					*pc = *sp;
-				}
+				*pc = *sp;
 			}
 			sdx += icosx;
 			sdy += isiny;
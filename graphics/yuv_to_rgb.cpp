@@ -83,9 +83,15 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/array.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define YUV_TO_RGB_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -203,6 +209,117 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+#ifdef YUV_TO_RGB_USE_SSE2
+
+/**
+ * Converts rows of pixels eight at a time with SSE2.
+ *
+ * The chroma terms of a row are taken from the same tables as in the
+ * lookup table conversion, and the clamping and scaling of the luminance
+ * scale are done with integer math giving the same values as the lookup
+ * table, so the output is bit-exact with it.
+ */
+class YUVToRGBRowSSE2 {
+public:
+	YUVToRGBRowSSE2(const PixelFormat &format, YUVToRGBManager::LuminanceScale scale, const int16 *colorTab, int maxChroma) :
+			_colorTab(colorTab), _scale(scale), _chroma(3 * maxChroma) {
+		_rLoss = _mm_cvtsi32_si128(format.rLoss);
+		_gLoss = _mm_cvtsi32_si128(format.gLoss);
+		_bLoss = _mm_cvtsi32_si128(format.bLoss);
+		_aLoss = _mm_cvtsi32_si128(format.aLoss);
+		_rShift = _mm_cvtsi32_si128(format.rShift);
+		_gShift = _mm_cvtsi32_si128(format.gShift);
+		_bShift = _mm_cvtsi32_si128(format.bShift);
+		_aShift = _mm_cvtsi32_si128(format.aShift);
+	}
+
+	/** Look up the chroma terms of count chroma samples. */
+	void setChroma(const byte *uSrc, const byte *vSrc, int count) {
+		const int16 *Cr_r_tab = _colorTab;
+		const int16 *Cr_g_tab = Cr_r_tab + 256;
+		const int16 *Cb_g_tab = Cr_g_tab + 256;
+		const int16 *Cb_b_tab = Cb_g_tab + 256;
+		const int maxChroma = _chroma.size() / 3;
+		int16 *crR = _chroma.begin(), *crbG = crR + maxChroma, *cbB = crbG + maxChroma;
+
+		// Remove the offsets into the lookup table from the terms
+		for (int i = 0; i < count; i++) {
+			crR[i] = Cr_r_tab[vSrc[i]] - (0 * 768 + 256);
+			crbG[i] = Cr_g_tab[vSrc[i]] + Cb_g_tab[uSrc[i]] - (1 * 768 + 256);
+			cbB[i] = Cb_b_tab[uSrc[i]] - (2 * 768 + 256);
+		}
+	}
+
+	/**
+	 * Convert the longest prefix of a row which is a multiple of eight
+	 * pixels long, and return its length. With halfChroma, every chroma
+	 * sample is used for two pixels.
+	 */
+	template<typename PixelInt, bool halfChroma>
+	int convert(byte *dst, const byte *ySrc, const byte *aSrc, int width) const {
+		const __m128i zero = _mm_setzero_si128();
+		const int maxChroma = _chroma.size() / 3;
+		const int16 *crR = _chroma.begin(), *crbG = crR + maxChroma, *cbB = crbG + maxChroma;
+
+		int x = 0;
+		for (; x + 8 <= width; x += 8) {
+			const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero);
+			const __m128i r = clamp(_mm_add_epi16(y, loadChroma<halfChroma>(crR, x)));
+			const __m128i g = clamp(_mm_add_epi16(y, loadChroma<halfChroma>(crbG, x)));
+			const __m128i b = clamp(_mm_add_epi16(y, loadChroma<halfChroma>(cbB, x)));
+			const __m128i a = aSrc ? _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(aSrc + x)), zero) : _mm_set1_epi16(0xFF);
+
+			if (sizeof(PixelInt) == 2) {
+				_mm_storeu_si128((__m128i *)dst + x / 8, pack16(r, g, b, a));
+			} else {
+				_mm_storeu_si128((__m128i *)dst + x / 4, pack32(_mm_unpacklo_epi16(r, zero), _mm_unpacklo_epi16(g, zero), _mm_unpacklo_epi16(b, zero), _mm_unpacklo_epi16(a, zero)));
+				_mm_storeu_si128((__m128i *)dst + x / 4 + 1, pack32(_mm_unpackhi_epi16(r, zero), _mm_unpackhi_epi16(g, zero), _mm_unpackhi_epi16(b, zero), _mm_unpackhi_epi16(a, zero)));
+			}
+		}
+		return x;
+	}
+
+private:
+	template<bool halfChroma>
+	static inline __m128i loadChroma(const int16 *terms, int x) {
+		if (!halfChroma)
+			return _mm_loadu_si128((const __m128i *)(terms + x));
+
+		const __m128i half = _mm_loadl_epi64((const __m128i *)(terms + x / 2));
+		return _mm_unpacklo_epi16(half, half);
+	}
+
+	/** Clamp the values to the luminance range and scale them to [0, 255]. */
+	inline __m128i clamp(__m128i value) const {
+		if (_scale == YUVToRGBManager::kScaleFull)
+			return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+
+		// (value - 16) * 255 / 219, with the division done as multiplication
+		value = _mm_sub_epi16(_mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(235)), _mm_set1_epi16(16));
+		return _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(value, _mm_set1_epi16(255)), _mm_set1_epi16((int16)38305)), 7);
+	}
+
+	inline __m128i pack16(__m128i r, __m128i g, __m128i b, __m128i a) const {
+		return _mm_or_si128(
+			_mm_or_si128(_mm_sll_epi16(_mm_srl_epi16(r, _rLoss), _rShift), _mm_sll_epi16(_mm_srl_epi16(g, _gLoss), _gShift)),
+			_mm_or_si128(_mm_sll_epi16(_mm_srl_epi16(b, _bLoss), _bShift), _mm_sll_epi16(_mm_srl_epi16(a, _aLoss), _aShift)));
+	}
+
+	inline __m128i pack32(__m128i r, __m128i g, __m128i b, __m128i a) const {
+		return _mm_or_si128(
+			_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(r, _rLoss), _rShift), _mm_sll_epi32(_mm_srl_epi32(g, _gLoss), _gShift)),
+			_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(b, _bLoss), _bShift), _mm_sll_epi32(_mm_srl_epi32(a, _aLoss), _aShift)));
+	}
+
+	const int16 *_colorTab;
+	YUVToRGBManager::LuminanceScale _scale;
+	Common::Array<int16> _chroma;
+	__m128i _rLoss, _gLoss, _bLoss, _aLoss;
+	__m128i _rShift, _gShift, _bShift, _aShift;
+};
+
+#endif
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -216,8 +333,22 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+#ifdef YUV_TO_RGB_USE_SSE2
+	YUVToRGBRowSSE2 rowConverter(lookup->getFormat(), lookup->getScale(), colorTab, yWidth);
+#endif
+
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		int w = 0;
+#ifdef YUV_TO_RGB_USE_SSE2
+		rowConverter.setChroma(uSrc, vSrc, yWidth);
+		w = rowConverter.convert<PixelInt, false>(dstPtr, ySrc, nullptr, yWidth);
+		ySrc += w;
+		uSrc += w;
+		vSrc += w;
+		dstPtr += w * sizeof(PixelInt);
+#endif
+
+		for (; w < yWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -265,8 +396,24 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+#ifdef YUV_TO_RGB_USE_SSE2
+	YUVToRGBRowSSE2 rowConverter(lookup->getFormat(), lookup->getScale(), colorTab, halfWidth);
+#endif
+
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+#ifdef YUV_TO_RGB_USE_SSE2
+		rowConverter.setChroma(uSrc, vSrc, halfWidth);
+		const int converted = rowConverter.convert<PixelInt, true>(dstPtr, ySrc, nullptr, yWidth);
+		rowConverter.convert<PixelInt, true>(dstPtr + dstPitch, ySrc + yPitch, nullptr, yWidth);
+		w = converted / 2;
+		ySrc += converted;
+		uSrc += w;
+		vSrc += w;
+		dstPtr += converted * sizeof(PixelInt);
+#endif
+
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -285,7 +432,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -326,8 +473,25 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 	const uint32 *aToPix = lookup->getAlphaToPix();
 
+#ifdef YUV_TO_RGB_USE_SSE2
+	YUVToRGBRowSSE2 rowConverter(lookup->getFormat(), lookup->getScale(), colorTab, halfWidth);
+#endif
+
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+#ifdef YUV_TO_RGB_USE_SSE2
+		rowConverter.setChroma(uSrc, vSrc, halfWidth);
+		const int converted = rowConverter.convert<PixelInt, true>(dstPtr, ySrc, aSrc, yWidth);
+		rowConverter.convert<PixelInt, true>(dstPtr + dstPitch, ySrc + yPitch, aSrc + yPitch, yWidth);
+		w = converted / 2;
+		ySrc += converted;
+		aSrc += converted;
+		uSrc += w;
+		vSrc += w;
+		dstPtr += converted * sizeof(PixelInt);
+#endif
+
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -348,7 +512,7 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		aSrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
@@ -408,8 +572,40 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 
 	int quarterWidth = yWidth >> 2;
 
+#ifdef YUV_TO_RGB_USE_SSE2
+	YUVToRGBRowSSE2 rowConverter(lookup->getFormat(), lookup->getScale(), colorTab, yWidth);
+	Common::Array<byte> chromaRow(2 * yWidth);
+#endif
+
 	for (int y = 0; y < yHeight; y++) {
-		for (int x = 0; x < quarterWidth; x++) {
+		int x = 0;
+#ifdef YUV_TO_RGB_USE_SSE2
+		// Interpolate the chroma values of the row up front, just like below
+		const int vectorWidth = yWidth & ~7;
+		byte *uRow = chromaRow.begin();
+		byte *vRow = uRow + yWidth;
+		for (int i = 0; i < vectorWidth; i++) {
+			int xDiff = i & 3;
+			int yDiff = y & 3;
+			int index = (y >> 2) * uvPitch + (i >> 2);
+			byte u, v;
+
+			READ_QUAD(uSrc, u);
+			READ_QUAD(vSrc, v);
+			DO_INTERPOLATION(u);
+			DO_INTERPOLATION(v);
+			uRow[i] = u;
+			vRow[i] = v;
+		}
+
+		rowConverter.setChroma(uRow, vRow, vectorWidth);
+		rowConverter.convert<PixelInt, false>(dstPtr, ySrc, nullptr, vectorWidth);
+		x = vectorWidth >> 2;
+		ySrc += vectorWidth;
+		dstPtr += vectorWidth * sizeof(PixelInt);
+#endif
+
+		for (; x < quarterWidth; x++) {
 			// Perform bilinear interpolation on the the chroma values
 			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
 			// Feel free to optimize further
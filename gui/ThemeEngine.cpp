@@ -89,6 +89,26 @@ struct WidgetDrawData {
 
 	DrawLayer _layer;
 
+	/**
+	 * Whether all draw steps set the colors they use, so that the drawn
+	 * pixels only depend on the drawn area and on what was below it.
+	 */
+	bool _cacheable;
+
+	/** A previous rendering of the draw steps, with the pixels it was drawn over */
+	struct CachedRender {
+		int16 width, height;
+		bool oddX, oddY;
+		uint32 dynamic;
+		Graphics::Surface background;
+		Graphics::Surface result;
+	};
+
+	/** Most recently used renderings first */
+	Common::List<CachedRender> _cachedRenders;
+
+	WidgetDrawData() : _cacheable(false) {}
+	~WidgetDrawData() { clearCachedRenders(); }
 
 	/**
 	 * Calculates the background threshold offset of a given DrawData item.
@@ -98,6 +118,29 @@ struct WidgetDrawData {
 	 * value will be added when restoring the background of the widget.
 	 */
 	void calcBackgroundOffset();
+
+	/** Calculates whether the renderings of this DrawData item may be cached. */
+	void calcCacheable();
+
+	/**
+	 * Copies a previous rendering of the given area onto the surface, when
+	 * one was drawn over the same pixels which are now on the surface.
+	 *
+	 * @param surface      The surface to draw on.
+	 * @param area         The area the draw steps are drawn into.
+	 * @param dirty        The area covered by the draw steps, which includes area.
+	 * @param dynamic      The dynamic data passed to the draw steps.
+	 * @return true if a rendering was found and copied.
+	 */
+	bool drawCachedRender(Graphics::Surface &surface, const Common::Rect &area, const Common::Rect &dirty, uint32 dynamic);
+
+	/**
+	 * Remembers the rendering of the given area, which was drawn over the
+	 * pixels in background. The cache takes ownership of background.
+	 */
+	void addCachedRender(const Graphics::Surface &surface, const Common::Rect &area, const Common::Rect &dirty, uint32 dynamic, Graphics::Surface &background);
+
+	void clearCachedRenders();
 };
 
 /**********************************************************
@@ -467,6 +510,12 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
 
+	// Renderings made with the previous renderer are not valid anymore
+	for (int i = 0; i < kDrawDataMAX; ++i) {
+		if (_widgets[i])
+			_widgets[i]->clearCachedRenders();
+	}
+
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
@@ -489,6 +538,73 @@ void WidgetDrawData::calcBackgroundOffset() {
 	_shadowOffset = maxShadow;
 }
 
+void WidgetDrawData::calcCacheable() {
+	_cacheable = true;
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		// Colors which are not set get inherited from whatever was drawn before
+		if (!step->fgColor.set ||
+		    (step->fillMode == Graphics::VectorRenderer::kFillBackground && !step->bgColor.set) ||
+		    (step->fillMode == Graphics::VectorRenderer::kFillGradient && !(step->gradColor1.set && step->gradColor2.set)) ||
+		    (step->bevel && !step->bevelColor.set))
+			_cacheable = false;
+	}
+}
+
+bool WidgetDrawData::drawCachedRender(Graphics::Surface &surface, const Common::Rect &area, const Common::Rect &dirty, uint32 dynamic) {
+	for (Common::List<CachedRender>::iterator i = _cachedRenders.begin(); i != _cachedRenders.end(); ++i) {
+		// Gradients are dithered depending on the position, so only the
+		// parity of the position must match
+		if (i->width != area.width() || i->height != area.height() || i->dynamic != dynamic ||
+		    i->oddX != (area.left & 1) || i->oddY != (area.top & 1) || i->background.format != surface.format)
+			continue;
+
+		const int rowSize = dirty.width() * surface.format.bytesPerPixel;
+		bool sameBackground = true;
+		for (int y = 0; y < dirty.height() && sameBackground; ++y)
+			sameBackground = !memcmp(surface.getBasePtr(dirty.left, dirty.top + y), i->background.getBasePtr(0, y), rowSize);
+		if (!sameBackground)
+			continue;
+
+		surface.copyRectToSurface(i->result, dirty.left, dirty.top, Common::Rect(dirty.width(), dirty.height()));
+
+		if (i != _cachedRenders.begin()) {
+			_cachedRenders.push_front(*i);
+			_cachedRenders.erase(i);
+		}
+		return true;
+	}
+	return false;
+}
+
+void WidgetDrawData::addCachedRender(const Graphics::Surface &surface, const Common::Rect &area, const Common::Rect &dirty, uint32 dynamic, Graphics::Surface &background) {
+	// Keep only a few renderings, e.g. of the different widget sizes in a dialog
+	static const uint kMaxCachedRenders = 4;
+	if (_cachedRenders.size() >= kMaxCachedRenders) {
+		_cachedRenders.back().background.free();
+		_cachedRenders.back().result.free();
+		_cachedRenders.pop_back();
+	}
+
+	CachedRender render;
+	render.width = area.width();
+	render.height = area.height();
+	render.oddX = (area.left & 1);
+	render.oddY = (area.top & 1);
+	render.dynamic = dynamic;
+	render.background = background;
+	render.result.copyFrom(surface.getSubArea(dirty));
+	_cachedRenders.push_front(render);
+}
+
+void WidgetDrawData::clearCachedRenders() {
+	for (Common::List<CachedRender>::iterator i = _cachedRenders.begin(); i != _cachedRenders.end(); ++i) {
+		i->background.free();
+		i->result.free();
+	}
+	_cachedRenders.clear();
+}
+
 void ThemeEngine::restoreBackground(Common::Rect r) {
 	if (_vectorRenderer->getActiveSurface() == &_backBuffer) {
 		// Only restore the background when drawing to the screen surface
@@ -817,6 +933,7 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->calcCacheable();
 		}
 	}
 }
@@ -971,7 +1088,13 @@ void ThemeEngine::drawDD(DrawData type, const Common::Rect &r, uint32 dynamic, b
 		extendedRect.bottom += drawData->_shadowOffset - drawData->_backgroundOffset;
 	}
 
+	// Renderings may only be reused when they are not clipped, and they are
+	// not worth keeping for large areas like dialog backgrounds
+	bool useCache = drawData->_cacheable && Common::Rect(_screen.w, _screen.h).contains(extendedRect) &&
+	                extendedRect.width() * extendedRect.height() <= kMaxCachedRenderArea;
+
 	if (!_clip.isEmpty()) {
+		useCache = useCache && _clip.contains(extendedRect);
 		extendedRect.clip(_clip);
 	}
 
@@ -984,9 +1107,25 @@ void ThemeEngine::drawDD(DrawData type, const Common::Rect &r, uint32 dynamic, b
 		restoreBackground(extendedRect);
 
 	if (drawData->_layer == _layerToDraw) {
+		Graphics::Surface &surface = *_vectorRenderer->getActiveSurface();
 		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step) {
-			_vectorRenderer->drawStep(area, _clip, *step, dynamic);
+		if (useCache && drawData->drawCachedRender(surface, area, extendedRect, dynamic)) {
+			// Later DrawData inherit the colors they don't set themselves,
+			// so leave the renderer as if the steps had been drawn
+			for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step) {
+				_vectorRenderer->applyStepState(area, _clip, *step, dynamic);
+			}
+		} else {
+			Graphics::Surface background;
+			if (useCache)
+				background.copyFrom(surface.getSubArea(extendedRect));
+
+			for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step) {
+				_vectorRenderer->drawStep(area, _clip, *step, dynamic);
+			}
+
+			if (useCache)
+				drawData->addCachedRender(surface, area, extendedRect, dynamic, background);
 		}
 
 		addDirtyRect(extendedRect);
@@ -328,6 +328,9 @@ public:
 	/** Constant value to expand dirty rectangles, to make sure they are fully copied */
 	static const int kDirtyRectangleThreshold = 1;
 
+	/** Largest area, in pixels, whose renderings get cached for reuse */
+	static const int kMaxCachedRenderArea = 320 * 64;
+
 	struct Renderer {
 		const char *name;
 		const char *shortname;
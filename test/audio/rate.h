@@ -0,0 +1,324 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+
+#include "common/array.h"
+#include "common/frac.h"
+#include "common/memstream.h"
+
+#include "test/random.h"
+
+/**
+ * Straightforward per-sample versions of the rate converters. The optimized
+ * converters in audio/rate.cpp must produce bit-identical output.
+ */
+class ReferenceRateConverter {
+public:
+	ReferenceRateConverter(const int16 *data, int length, uint32 inRate, uint32 outRate, bool stereo, bool reverseStereo)
+		: _data(data), _length(length), _pos(0), _stereo(stereo), _reverseStereo(reverseStereo) {
+		_opos = 1 << 15;
+		_oposInc = (inRate << 15) / outRate;
+		_simpleOpos = 1;
+		_simpleInc = inRate / outRate;
+		_copy = (inRate == outRate);
+		_simple = !_copy && (inRate % outRate) == 0 && inRate < 65536;
+		_ilast0 = _ilast1 = _icur0 = _icur1 = 0;
+	}
+
+	int flow(int16 *obuf, int osamp, uint16 volL, uint16 volR) {
+		int written = 0;
+		while (written < osamp) {
+			int16 out0, out1;
+			if (_copy) {
+				if (!readFrame(out0, out1))
+					break;
+			} else if (_simple) {
+				int16 skip0, skip1;
+				while (_simpleOpos > 0) {
+					if (!readFrame(skip0, skip1))
+						return written;
+					_simpleOpos--;
+				}
+				if (!readFrame(out0, out1))
+					return written;
+				_simpleOpos += _simpleInc - 1;
+			} else {
+				while (_opos >= (1 << 15)) {
+					int16 in0, in1;
+					if (!readFrame(in0, in1))
+						return written;
+					_ilast0 = _icur0;
+					_icur0 = in0;
+					_ilast1 = _icur1;
+					_icur1 = in1;
+					_opos -= 1 << 15;
+				}
+				out0 = (int16)(_ilast0 + (((_icur0 - _ilast0) * _opos + (1 << 14)) >> 15));
+				out1 = _stereo ? (int16)(_ilast1 + (((_icur1 - _ilast1) * _opos + (1 << 14)) >> 15)) : out0;
+				_opos += _oposInc;
+			}
+
+			Audio::clampedAdd(obuf[_reverseStereo    ], (out0 * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+			Audio::clampedAdd(obuf[_reverseStereo ^ 1], (out1 * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+			obuf += 2;
+			written++;
+		}
+		return written;
+	}
+
+private:
+	bool readFrame(int16 &out0, int16 &out1) {
+		if (_pos + (_stereo ? 2 : 1) > _length)
+			return false;
+		out0 = _data[_pos++];
+		out1 = _stereo ? _data[_pos++] : out0;
+		return true;
+	}
+
+	const int16 *_data;
+	int _length, _pos;
+	bool _stereo, _reverseStereo, _copy, _simple;
+	int32 _opos, _oposInc;
+	long _simpleOpos, _simpleInc;
+	int16 _ilast0, _ilast1, _icur0, _icur1;
+};
+
+class RateConverterTestSuite : public CxxTest::TestSuite {
+private:
+	TestRandom _random;
+
+	int16 randomSample() {
+		return (int16)(_random.next() >> 8);
+	}
+
+	void compareTemplate(uint32 inRate, uint32 outRate, bool stereo, bool reverseStereo, uint16 volL, uint16 volR) {
+		_random.setSeed(inRate ^ (outRate << 8) ^ (stereo ? 0x55 : 0) ^ (reverseStereo ? 0xAA : 0));
+
+		const int inFrames = 3000;
+		const int inSamples = inFrames * (stereo ? 2 : 1);
+		const int outFrames = inFrames * 5;
+
+		int16 *input = new int16[inSamples];
+		byte *raw = (byte *)malloc(inSamples * 2);
+		for (int i = 0; i < inSamples; ++i) {
+			input[i] = randomSample();
+			WRITE_LE_UINT16(raw + i * 2, input[i]);
+		}
+
+		// Prefill the output with large values so that saturation kicks in
+		int16 *expected = new int16[outFrames * 2];
+		int16 *actual = new int16[outFrames * 2];
+		for (int i = 0; i < outFrames * 2; ++i)
+			expected[i] = actual[i] = (i % 3) ? randomSample() : (int16)((i & 8) ? 32000 : -32000);
+
+		Common::SeekableReadStream *memStream = new Common::MemoryReadStream(raw, inSamples * 2, DisposeAfterUse::YES);
+		Audio::AudioStream *stream = Audio::makeRawStream(memStream, inRate,
+		                             Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0));
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo);
+		ReferenceRateConverter reference(input, inSamples, inRate, outRate, stereo, reverseStereo);
+
+		// Use odd request sizes to exercise the block boundaries
+		static const int chunks[] = { 1, 3, 7, 255, 256, 257, 1000 };
+		int pos = 0;
+		for (int i = 0; pos < outFrames; ++i) {
+			const int chunk = MIN<int>(chunks[i % ARRAYSIZE(chunks)], outFrames - pos);
+			const int got = converter->flow(*stream, actual + pos * 2, chunk, volL, volR);
+			const int want = reference.flow(expected + pos * 2, chunk, volL, volR);
+			TS_ASSERT_EQUALS(got, want);
+			if (got != want || got == 0)
+				break;
+			pos += got;
+		}
+
+		TS_ASSERT_EQUALS(memcmp(expected, actual, outFrames * 2 * sizeof(int16)), 0);
+
+		delete converter;
+		delete stream;
+		delete[] input;
+		delete[] expected;
+		delete[] actual;
+	}
+
+	void compareRates(uint32 inRate, uint32 outRate) {
+		compareTemplate(inRate, outRate, false, false, 256, 256);
+		compareTemplate(inRate, outRate, false, false, 37, 200);
+		compareTemplate(inRate, outRate, true, false, 256, 256);
+		compareTemplate(inRate, outRate, true, false, 0, 129);
+		compareTemplate(inRate, outRate, true, true, 256, 256);
+		compareTemplate(inRate, outRate, true, true, 211, 13);
+	}
+
+	/**
+	 * Convert a mono sine wave and return the left output channel, without
+	 * the filter run-in and run-out.
+	 */
+	Common::Array<double> convertSine(Audio::RateConverterQuality quality, uint32 inRate, uint32 outRate, double freq) {
+		const int inFrames = inRate / 2;
+		byte *raw = (byte *)malloc(inFrames * 2);
+		for (int i = 0; i < inFrames; ++i)
+			WRITE_LE_UINT16(raw + i * 2, (int16)floor(16000.0 * sin(2 * M_PI * freq * i / inRate) + 0.5));
+
+		Common::SeekableReadStream *memStream = new Common::MemoryReadStream(raw, inFrames * 2, DisposeAfterUse::YES);
+		Audio::AudioStream *stream = Audio::makeRawStream(memStream, inRate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, quality);
+
+		const int outFrames = (int)((uint64)inFrames * outRate / inRate);
+		int16 *out = new int16[outFrames * 2];
+		memset(out, 0, outFrames * 2 * sizeof(int16));
+		const int got = converter->flow(*stream, out, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+
+		Common::Array<double> result;
+		for (int i = 200; i < got - 200; ++i)
+			result.push_back(out[i * 2]);
+
+		delete[] out;
+		delete converter;
+		delete stream;
+		return result;
+	}
+
+	/** Signal to noise ratio against the ideal resampled sine, in dB */
+	double measureSNR(Audio::RateConverterQuality quality, uint32 inRate, uint32 outRate, double freq) {
+		Common::Array<double> out = convertSine(quality, inRate, outRate, freq);
+		double signal = 0, noise = 0;
+		for (uint i = 0; i < out.size(); ++i) {
+			const double expected = 16000.0 * sin(2 * M_PI * freq * (i + 200) / outRate);
+			signal += expected * expected;
+			noise += (out[i] - expected) * (out[i] - expected);
+		}
+		return 10 * log10(signal / noise);
+	}
+
+	/** Attenuation of a tone above the output Nyquist frequency, in dB */
+	double measureAliasRejection(Audio::RateConverterQuality quality, uint32 inRate, uint32 outRate, double freq) {
+		Common::Array<double> out = convertSine(quality, inRate, outRate, freq);
+		double power = 0;
+		for (uint i = 0; i < out.size(); ++i)
+			power += out[i] * out[i];
+		return 10 * log10(16000.0 * 16000.0 / 2 / (power / out.size()));
+	}
+
+public:
+	void test_copy_rate_converter() {
+		compareRates(22050, 22050);
+		compareRates(44100, 44100);
+	}
+
+	void test_simple_rate_converter() {
+		compareRates(44100, 22050);
+		compareRates(44100, 11025);
+	}
+
+	void test_linear_rate_converter() {
+		compareRates(11025, 44100);
+		compareRates(22050, 48000);
+		compareRates(48000, 44100);
+		compareRates(8000, 22050);
+	}
+
+	void test_sinc_rate_converter_quality() {
+		TS_ASSERT_LESS_THAN(60.0, measureSNR(Audio::kRateConverterSincMedium, 22050, 48000, 1000));
+		TS_ASSERT_LESS_THAN(75.0, measureSNR(Audio::kRateConverterSincHigh, 22050, 48000, 1000));
+		TS_ASSERT_LESS_THAN(45.0, measureSNR(Audio::kRateConverterSincMedium, 44100, 22050, 3000));
+		TS_ASSERT_LESS_THAN(75.0, measureSNR(Audio::kRateConverterSincHigh, 44100, 22050, 3000));
+	}
+
+	void test_sinc_rate_converter_aliasing() {
+		// 15 kHz is above the Nyquist frequency of the output rate, so the
+		// tone must be filtered out instead of folding back to 7050 Hz
+		TS_ASSERT_LESS_THAN(35.0, measureAliasRejection(Audio::kRateConverterSincMedium, 48000, 22050, 15000));
+		TS_ASSERT_LESS_THAN(70.0, measureAliasRejection(Audio::kRateConverterSincHigh, 48000, 22050, 15000));
+		TS_ASSERT_LESS_THAN(measureAliasRejection(Audio::kRateConverterLinear, 48000, 22050, 15000), 10.0);
+	}
+
+	void test_sinc_rate_converter_chunks() {
+		// The output must not depend on how the mixer splits its requests
+		static const int rates[][2] = { { 22050, 48000 }, { 48000, 22050 }, { 11025, 44100 } };
+		for (uint r = 0; r < ARRAYSIZE(rates); ++r) {
+			const int inFrames = 3000, inSamples = inFrames * 2;
+			const int outFrames = (int)((uint64)inFrames * rates[r][1] / rates[r][0]);
+
+			_random.setSeed(r);
+			byte *raw = (byte *)malloc(inSamples * 2);
+			for (int i = 0; i < inSamples; ++i)
+				WRITE_LE_UINT16(raw + i * 2, randomSample() / 2);
+			byte *rawCopy = (byte *)malloc(inSamples * 2);
+			memcpy(rawCopy, raw, inSamples * 2);
+
+			Audio::AudioStream *whole = Audio::makeRawStream(new Common::MemoryReadStream(raw, inSamples * 2, DisposeAfterUse::YES),
+			                            rates[r][0], Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | Audio::FLAG_STEREO);
+			Audio::AudioStream *split = Audio::makeRawStream(new Common::MemoryReadStream(rawCopy, inSamples * 2, DisposeAfterUse::YES),
+			                            rates[r][0], Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | Audio::FLAG_STEREO);
+			Audio::RateConverter *wholeConverter = Audio::makeRateConverter(rates[r][0], rates[r][1], true, true, Audio::kRateConverterSincHigh);
+			Audio::RateConverter *splitConverter = Audio::makeRateConverter(rates[r][0], rates[r][1], true, true, Audio::kRateConverterSincHigh);
+
+			int16 *expected = new int16[outFrames * 2];
+			int16 *actual = new int16[outFrames * 2];
+			memset(expected, 0, outFrames * 2 * sizeof(int16));
+			memset(actual, 0, outFrames * 2 * sizeof(int16));
+
+			const int total = wholeConverter->flow(*whole, expected, outFrames, 200, 100);
+			static const int chunks[] = { 1, 3, 7, 255, 256, 257, 1000 };
+			int pos = 0;
+			for (int i = 0; pos < total; ++i) {
+				const int got = splitConverter->flow(*split, actual + pos * 2, MIN<int>(chunks[i % ARRAYSIZE(chunks)], total - pos), 200, 100);
+				if (got == 0)
+					break;
+				pos += got;
+			}
+
+			TS_ASSERT_EQUALS(pos, total);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, outFrames * 2 * sizeof(int16)), 0);
+
+			delete wholeConverter;
+			delete splitConverter;
+			delete whole;
+			delete split;
+			delete[] expected;
+			delete[] actual;
+		}
+	}
+
+	void test_sinc_rate_converter_drain() {
+		// Draining must output the frames up to the end of the input, which
+		// only fit into the filter window with the silence after the input.
+		// The output then lasts exactly as long as the input.
+		static const int rates[][2] = { { 22050, 48000 }, { 48000, 22050 }, { 11025, 44100 } };
+		static const Audio::RateConverterQuality qualities[] = { Audio::kRateConverterSincMedium, Audio::kRateConverterSincHigh };
+		for (uint q = 0; q < ARRAYSIZE(qualities); ++q) {
+			for (uint r = 0; r < ARRAYSIZE(rates); ++r) {
+				const int inFrames = 1000;
+				byte *raw = (byte *)malloc(inFrames * 2);
+				for (int i = 0; i < inFrames; ++i)
+					WRITE_LE_UINT16(raw + i * 2, 10000);
+
+				Audio::AudioStream *stream = Audio::makeRawStream(new Common::MemoryReadStream(raw, inFrames * 2, DisposeAfterUse::YES),
+				                             rates[r][0], Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+				Audio::RateConverter *converter = Audio::makeRateConverter(rates[r][0], rates[r][1], false, false, qualities[q]);
+
+				const int expected = (int)(((uint64)inFrames * rates[r][1] + rates[r][0] - 1) / rates[r][0]);
+				const int bufferFrames = expected + 100;
+				int16 *out = new int16[bufferFrames * 2];
+				memset(out, 0, bufferFrames * 2 * sizeof(int16));
+
+				int total = converter->flow(*stream, out, bufferFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+				TS_ASSERT(stream->endOfStream());
+				TS_ASSERT_LESS_THAN(total, expected);
+				total += converter->drain(out + total * 2, bufferFrames - total, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+				TS_ASSERT_EQUALS(total, expected);
+				TS_ASSERT_EQUALS(converter->drain(out + total * 2, bufferFrames - total, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 0);
+
+				// The level holds until shortly before the end of the input
+				const int beforeEnd = (int)((uint64)(inFrames - 2) * rates[r][1] / rates[r][0]);
+				TS_ASSERT_LESS_THAN(7000, out[beforeEnd * 2]);
+
+				delete[] out;
+				delete converter;
+				delete stream;
+			}
+		}
+	}
+};
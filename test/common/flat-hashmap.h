@@ -0,0 +1,232 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flat-hashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+#include "test/random.h"
+
+/** Equality functor counting how often it gets called */
+struct CountingEqualTo {
+	static uint _calls;
+	bool operator()(int x, int y) const { _calls++; return x == y; }
+};
+
+uint CountingEqualTo::_calls = 0;
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	TestRandom _random;
+
+
+public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		TS_ASSERT_EQUALS(container2["FOO"], "bar");
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 5; ++i)
+			container[i] = i * 10;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		TS_ASSERT_EQUALS(container.size(), 4u);
+		container[1] = 42;
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(1));
+		container.erase(17);
+		TS_ASSERT_EQUALS(container.size(), 4u);
+		for (int i = 0; i < 5; ++i)
+			container.erase(i);
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+
+		// We take a const ref now to ensure that the map
+		// is not modified by getVal.
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(containerRef.find(17), containerRef.end());
+
+		int value = 0;
+		TS_ASSERT(containerRef.tryGetVal(1, value));
+		TS_ASSERT_EQUALS(value, -1);
+		TS_ASSERT(!containerRef.tryGetVal(2, value));
+		TS_ASSERT_EQUALS(container.size(), 2u);
+	}
+
+	void test_copy() {
+		Common::FlatHashMap<int, Common::String> map1;
+		for (int i = 0; i < 100; ++i)
+			map1[i] = Common::String::format("%d", i);
+		map1.erase(50);
+
+		Common::FlatHashMap<int, Common::String> map2(map1), map3;
+		map3 = map1;
+		map1.clear();
+
+		TS_ASSERT_EQUALS(map2.size(), 99u);
+		TS_ASSERT_EQUALS(map3.size(), 99u);
+		TS_ASSERT_EQUALS(map2[42], "42");
+		TS_ASSERT_EQUALS(map3[99], "99");
+		TS_ASSERT(!map3.contains(50));
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 5; ++i)
+			container[i] = i;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j) {
+			int key = j->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT_EQUALS(j->_value, key);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		// Erasing through an iterator keeps it usable for advancing
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ++i) {
+			if (i->_key != 3)
+				container.erase(i);
+		}
+		TS_ASSERT_EQUALS(container.size(), 1u);
+		TS_ASSERT(container.contains(3));
+	}
+
+	void test_against_hashmap() {
+		// Random inserts and erases, some of them with colliding keys, must
+		// leave both maps with the same content. The erases make sure that
+		// deleted slots get reused and purged.
+		Common::FlatHashMap<int, int> flat;
+		Common::HashMap<int, int> reference;
+		_random.setSeed(1);
+
+		for (int round = 0; round < 20000; ++round) {
+			const int key = (int)(_random.next() % 3000) << ((round & 1) ? 8 : 0);
+			if (_random.next() % 3 == 0) {
+				flat.erase(key);
+				reference.erase(key);
+			} else {
+				flat[key] = round;
+				reference[key] = round;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+
+		uint count = 0;
+		for (Common::FlatHashMap<int, int>::const_iterator i = flat.begin(); i != flat.end(); ++i) {
+			TS_ASSERT(reference.contains(i->_key));
+			TS_ASSERT_EQUALS(reference[i->_key], i->_value);
+			count++;
+		}
+		TS_ASSERT_EQUALS(count, reference.size());
+	}
+
+	/**
+	 * Benchmark the number of key comparisons, which are what makes lookups
+	 * expensive for string keys, and which involve a pointer dereference per
+	 * probed slot in HashMap. The control bytes should avoid nearly all of
+	 * the comparisons with keys other than the wanted one.
+	 */
+	void test_comparison_benchmark() {
+		const int numKeys = 50000;
+		Common::FlatHashMap<int, int, Common::Hash<int>, CountingEqualTo> flat;
+		Common::HashMap<int, int, Common::Hash<int>, CountingEqualTo> reference;
+
+		_random.setSeed(2);
+		int *keys = new int[numKeys];
+		for (int i = 0; i < numKeys; ++i)
+			keys[i] = (int)_random.next();
+
+		uint flatCalls[4], referenceCalls[4];
+
+		// Insert
+		CountingEqualTo::_calls = 0;
+		for (int i = 0; i < numKeys; ++i)
+			flat[keys[i]] = i;
+		flatCalls[0] = CountingEqualTo::_calls;
+		CountingEqualTo::_calls = 0;
+		for (int i = 0; i < numKeys; ++i)
+			reference[keys[i]] = i;
+		referenceCalls[0] = CountingEqualTo::_calls;
+
+		// Lookups of present and missing keys
+		CountingEqualTo::_calls = 0;
+		for (int i = 0; i < numKeys; ++i) {
+			flat.contains(keys[i]);
+			flat.contains(~keys[i]);
+		}
+		flatCalls[1] = CountingEqualTo::_calls;
+		CountingEqualTo::_calls = 0;
+		for (int i = 0; i < numKeys; ++i) {
+			reference.contains(keys[i]);
+			reference.contains(~keys[i]);
+		}
+		referenceCalls[1] = CountingEqualTo::_calls;
+
+		// Erase half of the keys
+		CountingEqualTo::_calls = 0;
+		for (int i = 0; i < numKeys; i += 2)
+			flat.erase(keys[i]);
+		flatCalls[2] = CountingEqualTo::_calls;
+		CountingEqualTo::_calls = 0;
+		for (int i = 0; i < numKeys; i += 2)
+			reference.erase(keys[i]);
+		referenceCalls[2] = CountingEqualTo::_calls;
+
+		// Iterating must not compare anything at all
+		int64 flatSum = 0, referenceSum = 0;
+		CountingEqualTo::_calls = 0;
+		for (Common::FlatHashMap<int, int, Common::Hash<int>, CountingEqualTo>::const_iterator i = flat.begin(); i != flat.end(); ++i)
+			flatSum += i->_value;
+		for (Common::HashMap<int, int, Common::Hash<int>, CountingEqualTo>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			referenceSum += i->_value;
+		flatCalls[3] = referenceCalls[3] = CountingEqualTo::_calls;
+
+		TS_ASSERT_EQUALS(flatSum, referenceSum);
+		TS_ASSERT_EQUALS(flatCalls[3], 0u);
+		// Apart from the comparisons with the wanted key, only few should
+		// be needed: the control bytes have 7 bits of the hash
+		const uint hits[3] = { 0, numKeys, numKeys / 2 };
+		for (int i = 0; i < 3; ++i) {
+			TS_ASSERT_LESS_THAN_EQUALS(flatCalls[i], referenceCalls[i]);
+			TS_ASSERT_LESS_THAN(flatCalls[i], hits[i] + numKeys / 4);
+		}
+
+		delete[] keys;
+	}
+};
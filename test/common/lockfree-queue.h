@@ -0,0 +1,64 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/lockfree-queue.h"
+
+class LockFreeQueueTestSuite : public CxxTest::TestSuite {
+public:
+	void test_capacity() {
+		Common::LockFreeQueue<int> queue(100);
+		TS_ASSERT_EQUALS(queue.capacity(), 128u);
+
+		Common::LockFreeQueue<int> exact(64);
+		TS_ASSERT_EQUALS(exact.capacity(), 64u);
+	}
+
+	void test_empty_size() {
+		Common::LockFreeQueue<int> queue(4);
+		TS_ASSERT(queue.empty());
+		TS_ASSERT_EQUALS(queue.size(), 0u);
+
+		queue.push(1);
+		queue.push(2);
+		TS_ASSERT(!queue.empty());
+		TS_ASSERT_EQUALS(queue.size(), 2u);
+
+		int value;
+		queue.pop(value);
+		TS_ASSERT_EQUALS(queue.size(), 1u);
+	}
+
+	void test_full_and_empty() {
+		Common::LockFreeQueue<int> queue(4);
+
+		for (int i = 0; i < 4; ++i)
+			TS_ASSERT(queue.push(i));
+		TS_ASSERT(!queue.push(4));
+		TS_ASSERT_EQUALS(queue.size(), 4u);
+
+		int value = -1;
+		for (int i = 0; i < 4; ++i) {
+			TS_ASSERT(queue.pop(value));
+			TS_ASSERT_EQUALS(value, i);
+		}
+		TS_ASSERT(!queue.pop(value));
+		TS_ASSERT_EQUALS(value, 3);
+	}
+
+	void test_wrap_around() {
+		Common::LockFreeQueue<int> queue(8);
+
+		// Interleave pushes and pops so the indices wrap around several times
+		int next = 0, expected = 0;
+		for (int round = 0; round < 100; ++round) {
+			for (int i = 0; i < 5; ++i)
+				TS_ASSERT(queue.push(next++));
+
+			int value;
+			for (int i = 0; i < 5; ++i) {
+				TS_ASSERT(queue.pop(value));
+				TS_ASSERT_EQUALS(value, expected++);
+			}
+		}
+		TS_ASSERT(queue.empty());
+	}
+};
@@ -104,4 +104,15 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_get_data() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		// The data is the buffer itself, wherever the stream is
+		ms.seek(3);
+		const byte *data = ms.getData();
+		TS_ASSERT_EQUALS(data, contents);
+		TS_ASSERT_EQUALS(ms.readByte(), data[3]);
+	}
 };
@@ -0,0 +1,253 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#include "test/random.h"
+
+class UnzipTestSuite : public CxxTest::TestSuite
+{
+	struct Member {
+		const char *name;
+		uint32 size;
+		uint16 method;
+		byte *data;
+		uint32 crc;
+		uint32 compressedSize;
+		byte *compressedData;
+		uint32 offset;
+	};
+
+	/** A zip file in memory, which can be opened several times. */
+	class MemoryMember : public Common::ArchiveMember {
+	public:
+		MemoryMember(const byte *data, uint32 size) : _data(data), _size(size) {}
+
+		Common::SeekableReadStream *createReadStream() const override {
+			return new Common::MemoryReadStream(_data, _size);
+		}
+		Common::String getName() const override { return "test.zip"; }
+
+	private:
+		const byte *_data;
+		uint32 _size;
+	};
+
+	TestRandom _random;
+	byte *_zipData;
+
+	static void writeLocalHeader(Common::WriteStream &zip, const Member &member) {
+		zip.writeUint32LE(0x04034b50);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(member.method);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(member.crc);
+		zip.writeUint32LE(member.compressedSize);
+		zip.writeUint32LE(member.size);
+		zip.writeUint16LE(strlen(member.name));
+		zip.writeUint16LE(0);
+		zip.writeString(member.name);
+	}
+
+	static void writeCentralHeader(Common::WriteStream &zip, const Member &member) {
+		zip.writeUint32LE(0x02014b50);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(member.method);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(member.crc);
+		zip.writeUint32LE(member.compressedSize);
+		zip.writeUint32LE(member.size);
+		zip.writeUint16LE(strlen(member.name));
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(member.offset);
+		zip.writeString(member.name);
+	}
+
+	/**
+	 * Deflate the data of a member. The gzip format is raw deflate data
+	 * between a 10 byte header and a trailer with the CRC and the size.
+	 */
+	static void compress(Member &member) {
+		Common::MemoryWriteStreamDynamic *gzipData = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(gzipData);
+		gzip->write(member.data, member.size);
+		gzip->finalize();
+
+		byte *data = gzipData->getData();
+		const uint32 size = gzipData->size();
+		delete gzip;
+
+		member.crc = READ_LE_UINT32(data + size - 8);
+		if (member.method == 8) {
+			member.compressedSize = size - 18;
+			member.compressedData = (byte *)malloc(member.compressedSize);
+			memcpy(member.compressedData, data + 10, member.compressedSize);
+		} else {
+			member.compressedSize = member.size;
+			member.compressedData = (byte *)malloc(member.size);
+			memcpy(member.compressedData, member.data, member.size);
+		}
+		free(data);
+	}
+
+	/** Create a zip archive in memory, with data which compresses somewhat. */
+	Common::Archive *createArchive(Member *members, int count) {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		for (int i = 0; i < count; ++i) {
+			Member &member = members[i];
+			member.data = (byte *)malloc(member.size);
+			for (uint32 j = 0; j < member.size; ++j)
+				member.data[j] = 'a' + (_random.next() >> 12) % 16;
+			compress(member);
+
+			member.offset = zip.pos();
+			writeLocalHeader(zip, member);
+			zip.write(member.compressedData, member.compressedSize);
+		}
+
+		const uint32 centralOffset = zip.pos();
+		for (int i = 0; i < count; ++i)
+			writeCentralHeader(zip, members[i]);
+		const uint32 centralSize = zip.pos() - centralOffset;
+
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(count);
+		zip.writeUint16LE(count);
+		zip.writeUint32LE(centralSize);
+		zip.writeUint32LE(centralOffset);
+		zip.writeUint16LE(0);
+
+		_zipData = zip.getData();
+		return Common::makeZipArchive(Common::ArchiveMemberPtr(new MemoryMember(_zipData, zip.size())));
+	}
+
+	void freeMembers(Member *members, int count) {
+		for (int i = 0; i < count; ++i) {
+			free(members[i].data);
+			free(members[i].compressedData);
+		}
+		free(_zipData);
+	}
+
+	static bool readsWhole(Common::Archive *archive, const Member &member) {
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember(member.name);
+		if (!stream)
+			return false;
+
+		byte *data = (byte *)malloc(member.size + 1);
+		const bool equal = stream->size() == (int32)member.size
+			&& stream->read(data, member.size + 1) == member.size
+			&& stream->eos() && !stream->err()
+			&& !memcmp(data, member.data, member.size);
+		free(data);
+		delete stream;
+		return equal;
+	}
+
+	/** Seek to random positions, forward and backward, and compare what is read there. */
+	bool readsRandomly(Common::SeekableReadStream *stream, const Member &member, int rounds) {
+		byte data[5000];
+		for (int i = 0; i < rounds; ++i) {
+			const uint32 pos = _random.next() % member.size;
+			const uint32 size = MIN<uint32>(_random.next() % sizeof(data), member.size - pos);
+			if (!stream->seek(pos) || stream->pos() != (int32)pos)
+				return false;
+			if (stream->read(data, size) != size || memcmp(data, member.data + pos, size))
+				return false;
+		}
+		return !stream->err();
+	}
+
+public:
+	void test_read_members() {
+#ifdef USE_ZLIB
+		// Both small members decompressed all at once and large ones
+		// decompressed while reading, with several checkpoints
+		Member members[] = {
+			{ "small.txt", 5000, 8, nullptr, 0, 0, nullptr, 0 },
+			{ "stored.bin", 300000, 0, nullptr, 0, 0, nullptr, 0 },
+			{ "large.bin", 3500000, 8, nullptr, 0, 0, nullptr, 0 }
+		};
+		_random.setSeed(1);
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+		TS_ASSERT(archive);
+
+		for (int i = 0; i < ARRAYSIZE(members); ++i) {
+			TS_ASSERT(archive->hasFile(members[i].name));
+			TS_ASSERT(readsWhole(archive, members[i]));
+		}
+
+		delete archive;
+		freeMembers(members, ARRAYSIZE(members));
+#endif
+	}
+
+	void test_seek_members() {
+#ifdef USE_ZLIB
+		Member members[] = {
+			{ "stored.bin", 300000, 0, nullptr, 0, 0, nullptr, 0 },
+			{ "large.bin", 3500000, 8, nullptr, 0, 0, nullptr, 0 }
+		};
+		_random.setSeed(2);
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+		TS_ASSERT(archive);
+
+		// Several streams at once, which also outlive the archive
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.bin");
+		Common::SeekableReadStream *large1 = archive->createReadStreamForMember("large.bin");
+		Common::SeekableReadStream *large2 = archive->createReadStreamForMember("large.bin");
+		TS_ASSERT(stored && large1 && large2);
+		delete archive;
+
+		for (int i = 0; i < 10; ++i) {
+			TS_ASSERT(readsRandomly(stored, members[0], 10));
+			TS_ASSERT(readsRandomly(large1, members[1], 10));
+			TS_ASSERT(readsRandomly(large2, members[1], 10));
+		}
+
+		// Reading past the end sets eos(), which clearErr() resets
+		byte tail[16];
+		TS_ASSERT(large1->seek(-8, SEEK_END));
+		TS_ASSERT_EQUALS(large1->read(tail, sizeof(tail)), 8u);
+		TS_ASSERT(large1->eos());
+		large1->clearErr();
+		TS_ASSERT(!large1->eos() && !large1->err());
+		TS_ASSERT(readsRandomly(large1, members[1], 5));
+
+		delete stored;
+		delete large1;
+		delete large2;
+		freeMembers(members, ARRAYSIZE(members));
+#endif
+	}
+
+	void test_unsupported_method() {
+#ifdef USE_ZLIB
+		// Stored data labelled as bzip2 compressed must not be inflated
+		Member members[] = {
+			{ "small.bz2", 5000, 12, nullptr, 0, 0, nullptr, 0 },
+			{ "large.bz2", 300000, 12, nullptr, 0, 0, nullptr, 0 }
+		};
+		_random.setSeed(3);
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+		TS_ASSERT(archive);
+
+		for (int i = 0; i < ARRAYSIZE(members); ++i) {
+			TS_ASSERT(archive->hasFile(members[i].name));
+			TS_ASSERT(!archive->createReadStreamForMember(members[i].name));
+		}
+
+		delete archive;
+		freeMembers(members, ARRAYSIZE(members));
+#endif
+	}
+};
@@ -0,0 +1,135 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/conversion.h"
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+
+#include "test/random.h"
+
+class ConversionTestSuite : public CxxTest::TestSuite
+{
+	TestRandom _random;
+
+	static uint32 readPixel(const byte *p, int bytesPerPixel) {
+		return (bytesPerPixel == 2) ? READ_UINT16(p) : READ_UINT32(p);
+	}
+
+	static void writePixel(byte *p, int bytesPerPixel, uint32 color) {
+		if (bytesPerPixel == 2)
+			WRITE_UINT16(p, color);
+		else
+			WRITE_UINT32(p, color);
+	}
+
+	/** Convert a rectangle one pixel at a time, the way crossBlit() does in general. */
+	static void convertReference(byte *dst, const byte *src, uint dstPitch, uint srcPitch, uint w, uint h,
+	                             const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		for (uint y = 0; y < h; ++y) {
+			for (uint x = 0; x < w; ++x) {
+				byte a, r, g, b;
+				srcFmt.colorToARGB(readPixel(src + y * srcPitch + x * srcFmt.bytesPerPixel, srcFmt.bytesPerPixel), a, r, g, b);
+				writePixel(dst + y * dstPitch + x * dstFmt.bytesPerPixel, dstFmt.bytesPerPixel, dstFmt.ARGBToColor(a, r, g, b));
+			}
+		}
+	}
+
+	static Graphics::PixelFormat format(int i) {
+		switch (i) {
+		case 0: return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		case 1: return Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+		case 2: return Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15);
+		case 3: return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		case 4: return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		case 5: return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+		case 6: return Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
+		default: return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		}
+	}
+
+public:
+	void test_crossblit() {
+		// All pairs of formats, including those with specialized converters,
+		// must give the same result as the plain conversion
+		const uint w = 21, h = 3, srcPitch = 100, dstPitch = 90;
+		byte src[srcPitch * h], dst[dstPitch * h], expected[dstPitch * h];
+		_random.setSeed(1);
+		for (uint i = 0; i < sizeof(src); ++i)
+			src[i] = _random.next() & 0xFF;
+
+		bool equal = true;
+		for (int i = 0; i < 8; ++i) {
+			for (int j = 0; j < 8; ++j) {
+				if (i == j)
+					continue;
+				memset(dst, 0, sizeof(dst));
+				memset(expected, 0, sizeof(expected));
+				TS_ASSERT(Graphics::crossBlit(dst, src, dstPitch, srcPitch, w, h, format(j), format(i)));
+				convertReference(expected, src, dstPitch, srcPitch, w, h, format(j), format(i));
+				equal = equal && !memcmp(dst, expected, sizeof(dst));
+			}
+		}
+		TS_ASSERT(equal);
+	}
+
+	void test_crossblit_in_place() {
+		const uint w = 19, h = 4;
+		byte buffer[w * h * 4], expected[w * h * 4];
+		_random.setSeed(2);
+
+		bool equal = true;
+		for (int i = 0; i < 8; ++i) {
+			for (int j = 0; j < 8; ++j) {
+				const Graphics::PixelFormat srcFmt = format(i), dstFmt = format(j);
+				if (i == j)
+					continue;
+				for (uint k = 0; k < sizeof(buffer); ++k)
+					buffer[k] = _random.next() & 0xFF;
+
+				convertReference(expected, buffer, w * dstFmt.bytesPerPixel, w * srcFmt.bytesPerPixel, w, h, dstFmt, srcFmt);
+				Graphics::crossBlit(buffer, buffer, w * dstFmt.bytesPerPixel, w * srcFmt.bytesPerPixel, w, h, dstFmt, srcFmt);
+				equal = equal && !memcmp(buffer, expected, w * h * dstFmt.bytesPerPixel);
+			}
+		}
+		TS_ASSERT(equal);
+	}
+
+	void test_convert_clut8() {
+		// Only the first 16 palette entries exist, and are used
+		byte palette[16 * 3];
+		_random.setSeed(3);
+		for (uint i = 0; i < sizeof(palette); ++i)
+			palette[i] = _random.next() & 0xFF;
+
+		Graphics::Surface surface;
+		surface.create(13, 7, Graphics::PixelFormat::createFormatCLUT8());
+		for (int y = 0; y < surface.h; ++y) {
+			for (int x = 0; x < surface.w; ++x)
+				*(byte *)surface.getBasePtr(x, y) = _random.next() % 16;
+		}
+
+		for (int i = 0; i < 8; ++i) {
+			const Graphics::PixelFormat dstFmt = format(i);
+			Graphics::Surface *converted = surface.convertTo(dstFmt, palette);
+			Graphics::Surface inPlace;
+			inPlace.copyFrom(surface);
+			inPlace.convertToInPlace(dstFmt, palette);
+
+			bool equal = true;
+			for (int y = 0; y < surface.h; ++y) {
+				for (int x = 0; x < surface.w; ++x) {
+					const byte *color = palette + *(const byte *)surface.getBasePtr(x, y) * 3;
+					const uint32 wanted = dstFmt.RGBToColor(color[0], color[1], color[2]);
+					equal = equal && readPixel((const byte *)converted->getBasePtr(x, y), dstFmt.bytesPerPixel) == wanted;
+					equal = equal && readPixel((const byte *)inPlace.getBasePtr(x, y), dstFmt.bytesPerPixel) == wanted;
+				}
+			}
+			TS_ASSERT(equal);
+
+			converted->free();
+			delete converted;
+			inPlace.free();
+		}
+
+		surface.free();
+	}
+};
@@ -0,0 +1,59 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_HQ_SCALERS
+#include "graphics/scaler/intern.h"
+
+#include "test/random.h"
+#endif
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_HQ_SCALERS
+	TestRandom _random;
+#endif
+
+public:
+	void test_hq_patterns() {
+#ifdef USE_HQ_SCALERS
+		// All combinations of YUV values right at and just past the thresholds
+		static const int colors = 27;
+		static const uint32 offsets[3][3] = { { 0, 0x30, 0x31 }, { 0, 7, 8 }, { 0, 6, 7 } };
+		uint32 *rgbToYuv = new uint32[65536];
+		memset(rgbToYuv, 0, 65536 * sizeof(uint32));
+		_random.setSeed(1);
+		for (int i = 0; i < colors; ++i) {
+			const uint32 y = 100 + offsets[0][i % 3], u = 100 + offsets[1][i / 3 % 3], v = 100 + offsets[2][i / 9];
+			rgbToYuv[i * 2017] = (y << 16) | (u << 8) | v;
+		}
+
+		// One pixel more than a chunk on each side, for the neighbors
+		const int pitch = kHQPatternChunk + 2;
+		uint16 pixels[pitch * 3];
+		bool equal = true;
+		for (int round = 0; round < 50; ++round) {
+			for (int i = 0; i < pitch * 3; ++i)
+				pixels[i] = (_random.next() % colors) * 2017;
+
+			const int count = 1 + _random.next() % kHQPatternChunk;
+			uint8 patterns[kHQPatternChunk];
+			hqPatterns(pixels + pitch + 1, pitch, count, rgbToYuv, patterns);
+
+			for (int x = 0; x < count; ++x) {
+				const uint16 *p = pixels + pitch + 1 + x;
+				const uint16 neighbors[8] = { p[-pitch - 1], p[-pitch], p[-pitch + 1], p[-1], p[1], p[pitch - 1], p[pitch], p[pitch + 1] };
+				int pattern = 0;
+				for (int n = 0; n < 8; ++n) {
+					if (diffYUV(rgbToYuv[*p], rgbToYuv[neighbors[n]]))
+						pattern |= 1 << n;
+				}
+				equal = equal && patterns[x] == pattern;
+			}
+		}
+		TS_ASSERT(equal);
+
+		delete[] rgbToYuv;
+#endif
+	}
+};
@@ -0,0 +1,105 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_TINYGL
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zdirtyrect.h"
+
+#include "test/random.h"
+#endif
+
+class TinyGLTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_TINYGL
+	static const int kWidth = 160;
+	static const int kHeight = 120;
+	static const int kFrames = 4;
+	static const int kTriangles = 24;
+
+	static float randomCoordinate(TestRandom &source, int size) {
+		// Reach a bit outside of the screen to get clipped triangles too
+		return (float)(int)(source.next() % (size + 40)) - 20.0f;
+	}
+
+	/**
+	 * Render the same frames into a new context, replaying the dirty
+	 * rectangles in bands of the given height, and append the color and
+	 * depth buffers after each frame to the given arrays.
+	 */
+	void renderFrames(int bandHeight, Common::Array<byte> &pixels, Common::Array<uint32> &depths) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		TinyGL::FrameBuffer *fb = new TinyGL::FrameBuffer(kWidth, kHeight, format);
+		TinyGL::glInit(fb, 256);
+		TinyGL::gl_get_context()->_dirtyRectBandHeight = bandHeight;
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglOrtho(0, kWidth, kHeight, 0, -1, 1);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglViewport(0, 0, kWidth, kHeight);
+		tglShadeModel(TGL_SMOOTH);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClearDepth(1.0);
+
+		TestRandom scene(0x1234);
+		for (int frame = 0; frame < kFrames; ++frame) {
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+			for (int i = 0; i < kTriangles; ++i) {
+				// Only some triangles change from one frame to the next, to
+				// get partial dirty regions
+				const bool moved = frame == 0 || scene.next() % 4 == 0;
+				TestRandom triangle(moved ? scene.next() : (uint32)(i * 7919 + 1));
+
+				if (triangle.next() % 3 == 0) {
+					tglEnable(TGL_BLEND);
+					tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+				} else {
+					tglDisable(TGL_BLEND);
+				}
+				if (triangle.next() % 4 == 0)
+					tglDisable(TGL_DEPTH_TEST);
+				else
+					tglEnable(TGL_DEPTH_TEST);
+
+				tglBegin(TGL_TRIANGLES);
+				for (int v = 0; v < 3; ++v) {
+					tglColor4ub(triangle.next() & 0xFF, triangle.next() & 0xFF, triangle.next() & 0xFF, triangle.next() & 0xFF);
+					tglVertex3f(randomCoordinate(triangle, kWidth), randomCoordinate(triangle, kHeight), (float)(int)(triangle.next() % 200 - 100) / 100.0f);
+				}
+				tglEnd();
+			}
+			TinyGL::tglPresentBuffer();
+
+			const byte *framePixels = fb->getPixelBuffer();
+			pixels.push_back(Common::Array<byte>(framePixels, kWidth * kHeight * format.bytesPerPixel));
+			const uint32 *frameDepths = fb->getZBuffer();
+			depths.push_back(Common::Array<uint32>(frameDepths, kWidth * kHeight));
+		}
+
+		TinyGL::glClose();
+		delete fb;
+	}
+
+	bool bandsMatch(int bandHeight) {
+		Common::Array<byte> pixels, bandPixels;
+		Common::Array<uint32> depths, bandDepths;
+		renderFrames(0, pixels, depths);
+		renderFrames(bandHeight, bandPixels, bandDepths);
+		return pixels == bandPixels && depths == bandDepths;
+	}
+#endif
+
+public:
+	void test_dirty_rect_bands() {
+#ifdef USE_TINYGL
+		// Band heights dividing the screen height evenly or not, and bands
+		// higher than the screen
+		TS_ASSERT(bandsMatch(1));
+		TS_ASSERT(bandsMatch(16));
+		TS_ASSERT(bandsMatch(37));
+		TS_ASSERT(bandsMatch(128));
+#endif
+	}
+};
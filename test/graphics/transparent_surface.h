@@ -0,0 +1,219 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transform_tools.h"
+#include "graphics/transparent_surface.h"
+
+#include "test/random.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+	TestRandom _random;
+
+	/** Fill a surface with random pixels. A third of them each get an alpha of 0, 255 or anything. */
+	void fillRandom(Graphics::Surface &surface) {
+		for (int y = 0; y < surface.h; ++y) {
+			for (int x = 0; x < surface.w; ++x) {
+				byte *pixel = (byte *)surface.getBasePtr(x, y);
+				for (int i = 0; i < 4; ++i)
+					pixel[i] = _random.next() & 0xFF;
+
+				const uint32 alphaKind = _random.next() % 3;
+				uint32 value = READ_UINT32(pixel);
+				value &= ~(0xFF << surface.format.aShift);
+				if (alphaKind == 1)
+					value |= 0xFF << surface.format.aShift;
+				else if (alphaKind == 2)
+					value |= (_random.next() & 0xFF) << surface.format.aShift;
+				WRITE_UINT32(pixel, value);
+			}
+		}
+	}
+
+	bool equalSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; ++y) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * 4))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Blit a sprite, and its mirror image flipped horizontally, onto two
+	 * copies of a target. Flipped sprites are always blended one pixel at a
+	 * time, so this compares the vectorized blending code with the plain
+	 * one. The odd widths make sure the remainders of rows get tested too.
+	 */
+	bool blitMatchesFlipped(Graphics::AlphaType alphaMode, uint color, Graphics::TSpriteBlendMode blendMode) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		static const int widths[] = { 1, 3, 4, 7, 16, 37, 64 };
+
+		for (int i = 0; i < ARRAYSIZE(widths); ++i) {
+			const int width = widths[i];
+			Graphics::TransparentSurface sprite, mirrored;
+			sprite.create(width, 5, format);
+			mirrored.create(width, 5, format);
+			fillRandom(sprite);
+			for (int y = 0; y < sprite.h; ++y) {
+				for (int x = 0; x < width; ++x)
+					WRITE_UINT32(mirrored.getBasePtr(width - 1 - x, y), READ_UINT32(sprite.getBasePtr(x, y)));
+			}
+			sprite.setAlphaMode(alphaMode);
+			mirrored.setAlphaMode(alphaMode);
+
+			Graphics::Surface target, expected;
+			target.create(width + 11, 8, format);
+			fillRandom(target);
+			expected.copyFrom(target);
+
+			sprite.blit(target, 3, 1, Graphics::FLIP_NONE, nullptr, color, -1, -1, blendMode);
+			mirrored.blit(expected, 3, 1, Graphics::FLIP_H, nullptr, color, -1, -1, blendMode);
+			const bool equal = equalSurfaces(target, expected);
+
+			sprite.free();
+			mirrored.free();
+			target.free();
+			expected.free();
+
+			if (!equal)
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Straightforward rotation and scaling, which checks every target pixel
+	 * for whether it maps into the source.
+	 */
+	void rotoscaleReference(const Graphics::TransparentSurface &src, const Graphics::TransformStruct &transform, bool bilinear, Graphics::Surface &target) {
+		Common::Point newHotspot;
+		const Common::Rect rect = Graphics::TransformTools::newRect(Common::Rect(0, 0, src.w, src.h), transform, &newHotspot);
+		target.create(rect.width(), rect.height(), src.format);
+
+		const float invAngleRad = Common::deg2rad<uint32, float>(360 - (transform._angle % 360));
+		const int icosx = (int)(cos(invAngleRad) * (65536.0f * Graphics::kDefaultZoomX / transform._zoom.x));
+		const int isinx = (int)(sin(invAngleRad) * (65536.0f * Graphics::kDefaultZoomX / transform._zoom.x));
+		const int icosy = (int)(cos(invAngleRad) * (65536.0f * Graphics::kDefaultZoomY / transform._zoom.y));
+		const int isiny = (int)(sin(invAngleRad) * (65536.0f * Graphics::kDefaultZoomY / transform._zoom.y));
+
+		for (int y = 0; y < target.h; y++) {
+			const int t = newHotspot.y - y;
+			int sdx = -icosx * newHotspot.x + isinx * t + (transform._hotspot.x << 16);
+			int sdy = -isiny * newHotspot.x - icosy * t + (transform._hotspot.y << 16);
+			for (int x = 0; x < target.w; x++, sdx += icosx, sdy += isiny) {
+				const int dx = sdx >> 16, dy = sdy >> 16;
+				byte *out = (byte *)target.getBasePtr(x, y);
+				if (!bilinear) {
+					if (dx >= 0 && dy >= 0 && dx < src.w && dy < src.h)
+						memcpy(out, src.getBasePtr(dx, dy), 4);
+					continue;
+				}
+				if (dx < 0 || dy < 0 || dx >= src.w - 1 || dy >= src.h - 1)
+					continue;
+
+				const byte *c00 = (const byte *)src.getBasePtr(dx, dy), *c01 = c00 + 4;
+				const byte *c10 = c00 + src.pitch, *c11 = c10 + 4;
+				const int ex = sdx & 0xffff, ey = sdy & 0xffff;
+				for (int i = 0; i < 4; ++i) {
+					const int t1 = ((((c01[i] - c00[i]) * ex) >> 16) + c00[i]) & 0xff;
+					const int t2 = ((((c11[i] - c10[i]) * ex) >> 16) + c10[i]) & 0xff;
+					out[i] = (((t2 - t1) * ey) >> 16) + t1;
+				}
+			}
+		}
+	}
+
+public:
+	void test_blit_opaque() {
+		// Opaque blits copy the pixels and make them opaque
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		_random.setSeed(1);
+
+		Graphics::TransparentSurface sprite;
+		sprite.create(37, 5, format);
+		fillRandom(sprite);
+		sprite.setAlphaMode(Graphics::ALPHA_OPAQUE);
+
+		Graphics::Surface target;
+		target.create(48, 8, format);
+		fillRandom(target);
+		sprite.blit(target, 3, 1);
+
+		bool equal = true;
+		for (int y = 0; y < sprite.h; ++y) {
+			for (int x = 0; x < sprite.w; ++x) {
+				const uint32 wanted = READ_UINT32(sprite.getBasePtr(x, y)) | (0xFF << format.aShift);
+				equal = equal && READ_UINT32(target.getBasePtr(x + 3, y + 1)) == wanted;
+			}
+		}
+		TS_ASSERT(equal);
+
+		sprite.free();
+		target.free();
+	}
+
+	void test_blit_binary() {
+		_random.setSeed(2);
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_BINARY, TS_ARGB(255, 255, 255, 255), Graphics::BLEND_NORMAL));
+	}
+
+	void test_blit_alpha() {
+		_random.setSeed(3);
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 255, 255, 255), Graphics::BLEND_NORMAL));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(128, 255, 64, 200), Graphics::BLEND_NORMAL));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 10, 255, 255), Graphics::BLEND_NORMAL));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_BINARY, TS_ARGB(1, 255, 255, 255), Graphics::BLEND_NORMAL));
+	}
+
+	void test_blit_additive() {
+		_random.setSeed(4);
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 255, 255, 255), Graphics::BLEND_ADDITIVE));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(200, 255, 100, 0), Graphics::BLEND_ADDITIVE));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 30, 255, 254), Graphics::BLEND_ADDITIVE));
+	}
+
+	void test_blit_subtractive() {
+		_random.setSeed(5);
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 255, 255, 255), Graphics::BLEND_SUBTRACTIVE));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 100, 255, 20), Graphics::BLEND_SUBTRACTIVE));
+	}
+
+	void test_blit_multiply() {
+		_random.setSeed(6);
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(255, 255, 255, 255), Graphics::BLEND_MULTIPLY));
+		TS_ASSERT(blitMatchesFlipped(Graphics::ALPHA_FULL, TS_ARGB(90, 255, 30, 140), Graphics::BLEND_MULTIPLY));
+	}
+
+	void test_rotoscale() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		static const int angles[] = { 1, 30, 45, 90, 135, 180, 211, 270, 359 };
+		static const int zooms[] = { 33, 100, 250 };
+		_random.setSeed(7);
+
+		Graphics::TransparentSurface sprite;
+		sprite.create(29, 17, format);
+		fillRandom(sprite);
+
+		bool equal = true;
+		for (int i = 0; i < ARRAYSIZE(angles); ++i) {
+			for (int j = 0; j < ARRAYSIZE(zooms); ++j) {
+				const Graphics::TransformStruct transform(zooms[j], zooms[ARRAYSIZE(zooms) - 1 - j], angles[i], 5 * j, 3 * i);
+				for (int bilinear = 0; bilinear < 2; ++bilinear) {
+					Graphics::TransparentSurface *result = bilinear ?
+						sprite.rotoscaleT<Graphics::FILTER_BILINEAR>(transform) :
+						sprite.rotoscaleT<Graphics::FILTER_NEAREST>(transform);
+					Graphics::Surface expected;
+					rotoscaleReference(sprite, transform, bilinear, expected);
+
+					equal = equal && result->w == expected.w && result->h == expected.h && equalSurfaces(*result, expected);
+
+					result->free();
+					delete result;
+					expected.free();
+				}
+			}
+		}
+		TS_ASSERT(equal);
+
+		sprite.free();
+	}
+};
@@ -0,0 +1,112 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "test/random.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+	enum {
+		kWidth = 44,
+		kHeight = 8,
+		kPitch = 48,
+		kStripWidth = 4
+	};
+
+	enum Subsampling {
+		k444,
+		k420,
+		k420Alpha,
+		k410
+	};
+
+	TestRandom _random;
+	byte _y[kPitch * kHeight], _u[kPitch * kHeight], _v[kPitch * kHeight], _a[kPitch * kHeight];
+
+	void convert(Subsampling subsampling, Graphics::Surface *dst, Graphics::YUVToRGBManager::LuminanceScale scale, int x, int width) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(dst, scale, _y + x, _u + x, _v + x, width, kHeight, kPitch, kPitch);
+			break;
+		case k420:
+			YUVToRGBMan.convert420(dst, scale, _y + x, _u + x / 2, _v + x / 2, width, kHeight, kPitch, kPitch);
+			break;
+		case k420Alpha:
+			YUVToRGBMan.convert420Alpha(dst, scale, _y + x, _u + x / 2, _v + x / 2, _a + x, width, kHeight, kPitch, kPitch);
+			break;
+		case k410:
+			YUVToRGBMan.convert410(dst, scale, _y + x, _u + x / 4, _v + x / 4, width, kHeight, kPitch, kPitch);
+			break;
+		}
+	}
+
+	/**
+	 * Convert a whole frame, and the same frame in strips too narrow for
+	 * the vectorized code, which thus get converted with the lookup tables
+	 * only. Both must give the same result.
+	 */
+	bool matchesLookup(Subsampling subsampling, const Graphics::PixelFormat &format) {
+		for (int i = 0; i < (int)sizeof(_y); ++i) {
+			_y[i] = _random.next() & 0xFF;
+			_u[i] = _random.next() & 0xFF;
+			_v[i] = _random.next() & 0xFF;
+			_a[i] = _random.next() & 0xFF;
+		}
+		// Include the extremes, which need clamping
+		_y[0] = _v[0] = 0;
+		_y[1] = _v[1] = 255;
+
+		bool equal = true;
+		for (int scale = 0; scale < 2; ++scale) {
+			const Graphics::YUVToRGBManager::LuminanceScale luminanceScale =
+				scale ? Graphics::YUVToRGBManager::kScaleITU : Graphics::YUVToRGBManager::kScaleFull;
+
+			Graphics::Surface frame, strips;
+			frame.create(kWidth, kHeight, format);
+			strips.create(kWidth, kHeight, format);
+
+			convert(subsampling, &frame, luminanceScale, 0, kWidth);
+			for (int x = 0; x < kWidth; x += kStripWidth) {
+				Graphics::Surface strip;
+				strip.init(kStripWidth, kHeight, strips.pitch, strips.getBasePtr(x, 0), format);
+				convert(subsampling, &strip, luminanceScale, x, kStripWidth);
+			}
+
+			for (int y = 0; y < kHeight; ++y)
+				equal = equal && !memcmp(frame.getBasePtr(0, y), strips.getBasePtr(0, y), kWidth * format.bytesPerPixel);
+
+			frame.free();
+			strips.free();
+		}
+		return equal;
+	}
+
+public:
+	void test_convert444() {
+		_random.setSeed(1);
+		TS_ASSERT(matchesLookup(k444, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)));
+		TS_ASSERT(matchesLookup(k444, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)));
+	}
+
+	void test_convert420() {
+		_random.setSeed(2);
+		TS_ASSERT(matchesLookup(k420, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)));
+		TS_ASSERT(matchesLookup(k420, Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0)));
+		TS_ASSERT(matchesLookup(k420, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24)));
+		TS_ASSERT(matchesLookup(k420, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)));
+		TS_ASSERT(matchesLookup(k420, Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)));
+	}
+
+	void test_convert420_alpha() {
+		_random.setSeed(3);
+		TS_ASSERT(matchesLookup(k420Alpha, Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0)));
+		TS_ASSERT(matchesLookup(k420Alpha, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)));
+	}
+
+	void test_convert410() {
+		_random.setSeed(4);
+		TS_ASSERT(matchesLookup(k410, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)));
+		TS_ASSERT(matchesLookup(k410, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24)));
+	}
+};
@@ -5,8 +5,19 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h
-TEST_LIBS    := audio/libaudio.a math/libmath.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h \
+	$(srcdir)/test/graphics/conversion.h \
+	$(srcdir)/test/graphics/transparent_surface.h \
+	$(srcdir)/test/graphics/yuv_to_rgb.h
+TEST_LIBS    := graphics/libgraphics.a audio/libaudio.a math/libmath.a common/libcommon.a
+
+ifdef USE_TINYGL
+	TESTS += $(srcdir)/test/graphics/tinygl.h
+endif
+
+ifdef USE_HQ_SCALERS
+	TESTS += $(srcdir)/test/graphics/scaler.h
+endif
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
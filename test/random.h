@@ -0,0 +1,26 @@
+#ifndef TEST_RANDOM_H
+#define TEST_RANDOM_H
+
+#include "common/scummsys.h"
+
+/**
+ * Pseudo random numbers for the unit tests. Unlike Common::RandomSource,
+ * the sequence only depends on the seed, so failures can be reproduced.
+ */
+class TestRandom {
+public:
+	TestRandom(uint32 seed = 0) : _seed(seed) {}
+
+	void setSeed(uint32 seed) { _seed = seed; }
+
+	/** Return 24 random bits. */
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+private:
+	uint32 _seed;
+};
+
+#endif
@@ -46,6 +46,11 @@
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define BINK_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
 static const uint32 kBIKhID = MKTAG('B', 'I', 'K', 'h');
@@ -61,6 +66,11 @@ static const uint32 kDCStartBits = 11;
 
 namespace Video {
 
+#ifdef BINK_USE_SSE2
+static void IDCTSSE2(__m128i *rows, const int32 *block);
+static inline __m128i IDCTRowBytesSSE2(const __m128i *row);
+#endif
+
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
 }
@@ -829,6 +839,17 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
+#ifdef BINK_USE_SSE2
+	__m128i rows[16];
+	IDCTSSE2(rows, block);
+	byte *dest = ctx.dest;
+	for (int j = 0; j < 8; j++, dest += ctx.pitch << 1) {
+		const __m128i pixels = IDCTRowBytesSSE2(rows + 2 * j);
+		const __m128i doubled = _mm_unpacklo_epi8(pixels, pixels);
+		_mm_storeu_si128((__m128i *)dest, doubled);
+		_mm_storeu_si128((__m128i *)(dest + ctx.pitch), doubled);
+	}
+#else
 	IDCT(block);
 
 	int32 *src   = block;
@@ -840,6 +861,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
 
 	}
+#endif
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
@@ -961,9 +983,18 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 
 	byte  *dst = ctx.dest;
 	int16 *src = block;
+#ifdef BINK_USE_SSE2
+	const __m128i mask = _mm_set1_epi16(0xFF);
+	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8) {
+		const __m128i residue = _mm_and_si128(_mm_loadu_si128((const __m128i *)src), mask);
+		const __m128i pixels = _mm_loadl_epi64((const __m128i *)dst);
+		_mm_storel_epi64((__m128i *)dst, _mm_add_epi8(pixels, _mm_packus_epi16(residue, residue)));
+	}
+#else
 	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
 		for (int j = 0; j < 8; j++)
 			dst[j] += src[j];
+#endif
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
@@ -1459,6 +1490,7 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 #define MUNGE_ROW(x) (((x) + 0x7F)>>8)
 #define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
 
+#ifndef BINK_USE_SSE2
 static inline void IDCTCol(int32 *dest, const int32 *src) {
 	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
 		dest[ 0] =
@@ -1473,8 +1505,113 @@ static inline void IDCTCol(int32 *dest, const int32 *src) {
 		IDCT_COL(dest, src);
 	}
 }
+#endif
+
+#ifdef BINK_USE_SSE2
+
+/** Multiply four signed 32-bit values by a constant, keeping the low 32 bits of the products. */
+static inline __m128i IDCTMulSSE2(__m128i x, int c) {
+	const __m128i k = _mm_set1_epi32(c);
+	const __m128i even = _mm_mul_epu32(x, k);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), k);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/** IDCT_TRANSFORM on four independent vectors of eight values at once. */
+static inline void IDCTTransformSSE2(__m128i *d, const __m128i *s) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = _mm_srai_epi32(IDCTMulSSE2(_mm_sub_epi32(s[2], s[6]), A1), 11);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = _mm_srai_epi32(IDCTMulSSE2(_mm_add_epi32(a5, a7), A3), 11);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(IDCTMulSSE2(a5, A4), 11), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(_mm_srai_epi32(IDCTMulSSE2(_mm_sub_epi32(a6, a4), A1), 11), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(_mm_srai_epi32(IDCTMulSSE2(a7, A2), 11), b3), b1);
+
+	const __m128i e0 = _mm_add_epi32(a0, a2);
+	const __m128i e1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i e2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i e3 = _mm_sub_epi32(a0, a2);
+	d[0] = _mm_add_epi32(e0, b0);
+	d[1] = _mm_add_epi32(e1, b2);
+	d[2] = _mm_add_epi32(e2, b3);
+	d[3] = _mm_sub_epi32(e3, b4);
+	d[4] = _mm_add_epi32(e3, b4);
+	d[5] = _mm_sub_epi32(e2, b3);
+	d[6] = _mm_sub_epi32(e1, b2);
+	d[7] = _mm_sub_epi32(e0, b0);
+}
+
+static inline void transpose4x4SSE2(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3) {
+	const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/**
+ * The whole IDCT of a block. The columns are transformed four at a time
+ * straight from the rows, the rows four at a time after transposing them.
+ * rows[2 * i] and rows[2 * i + 1] get the left and right half of row i.
+ */
+static void IDCTSSE2(__m128i *rows, const int32 *block) {
+	__m128i src[8], dst[8];
+	for (int half = 0; half < 2; half++) {
+		for (int i = 0; i < 8; i++)
+			src[i] = _mm_loadu_si128((const __m128i *)(block + 8 * i + 4 * half));
+		IDCTTransformSSE2(dst, src);
+		for (int i = 0; i < 8; i++)
+			rows[2 * i + half] = dst[i];
+	}
+
+	const __m128i round = _mm_set1_epi32(0x7F);
+	for (int quarter = 0; quarter < 2; quarter++) {
+		__m128i *r = rows + 8 * quarter;
+		for (int half = 0; half < 2; half++) {
+			src[4 * half + 0] = r[0 + half];
+			src[4 * half + 1] = r[2 + half];
+			src[4 * half + 2] = r[4 + half];
+			src[4 * half + 3] = r[6 + half];
+			transpose4x4SSE2(src[4 * half + 0], src[4 * half + 1], src[4 * half + 2], src[4 * half + 3]);
+		}
+		IDCTTransformSSE2(dst, src);
+		for (int i = 0; i < 8; i++)
+			dst[i] = _mm_srai_epi32(_mm_add_epi32(dst[i], round), 8);
+		for (int half = 0; half < 2; half++) {
+			transpose4x4SSE2(dst[4 * half + 0], dst[4 * half + 1], dst[4 * half + 2], dst[4 * half + 3]);
+			r[0 + half] = dst[4 * half + 0];
+			r[2 + half] = dst[4 * half + 1];
+			r[4 + half] = dst[4 * half + 2];
+			r[6 + half] = dst[4 * half + 3];
+		}
+	}
+}
+
+/** The low bytes of a row of eight values, like storing them into bytes would give. */
+static inline __m128i IDCTRowBytesSSE2(const __m128i *row) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i words = _mm_packs_epi32(_mm_and_si128(row[0], mask), _mm_and_si128(row[1], mask));
+	return _mm_packus_epi16(words, words);
+}
+
+#endif
 
 void BinkDecoder::BinkVideoTrack::IDCT(int32 *block) {
+#ifdef BINK_USE_SSE2
+	__m128i rows[16];
+	IDCTSSE2(rows, block);
+	for (int i = 0; i < 16; i++)
+		_mm_storeu_si128((__m128i *)(block + 4 * i), rows[i]);
+#else
 	int i;
 	int32 temp[64];
 
@@ -1483,9 +1620,19 @@ void BinkDecoder::BinkVideoTrack::IDCT(int32 *block) {
 	for (i = 0; i < 8; i++) {
 		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
 	}
+#endif
 }
 
 void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int32 *block) {
+#ifdef BINK_USE_SSE2
+	__m128i rows[16];
+	IDCTSSE2(rows, block);
+	byte *dest = ctx.dest;
+	for (int i = 0; i < 8; i++, dest += ctx.pitch) {
+		const __m128i pixels = _mm_loadl_epi64((const __m128i *)dest);
+		_mm_storel_epi64((__m128i *)dest, _mm_add_epi8(pixels, IDCTRowBytesSSE2(rows + 2 * i)));
+	}
+#else
 	int i, j;
 
 	IDCT(block);
@@ -1493,9 +1640,16 @@ void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int32 *block) {
 	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
 		for (j = 0; j < 8; j++)
 			 dest[j] += block[j];
+#endif
 }
 
 void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int32 *block) {
+#ifdef BINK_USE_SSE2
+	__m128i rows[16];
+	IDCTSSE2(rows, block);
+	for (int i = 0; i < 8; i++)
+		_mm_storel_epi64((__m128i *)(ctx.dest + i * ctx.pitch), IDCTRowBytesSSE2(rows + 2 * i));
+#else
 	int i;
 	int32 temp[64];
 	for (i = 0; i < 8; i++)
@@ -1503,6 +1657,7 @@ void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int32 *block) {
 	for (i = 0; i < 8; i++) {
 		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
 	}
+#endif
 }
 
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio, Audio::Mixer::SoundType soundType) :
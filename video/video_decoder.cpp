@@ -25,14 +25,26 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/config-manager.h"
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+/** A frame decoded ahead of time, with the playback state from before it was decoded. */
+struct VideoDecoder::PrefetchedFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+	int curFrame;
+	uint32 nextFrameStartTime;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,6 +61,9 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_prefetchFrameCount = MAX<int>(ConfMan.getInt("video_prefetch_frames"), 0);
+	_shownFrame = 0;
+	_prefetchDecodeTime = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -57,10 +72,23 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	flushPrefetchedFrames();
+	recycleShownFrame();
+
+	for (uint i = 0; i < _freeFrames.size(); i++) {
+		_freeFrames[i]->surface.free();
+		delete _freeFrames[i];
+	}
+}
+
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	flushPrefetchedFrames();
+	recycleShownFrame();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -185,6 +213,25 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	recycleShownFrame();
+
+	// When decoding ahead, the due frame goes through the queue as well, so
+	// that decoding more frames doesn't overwrite the one returned
+	if (_prefetchedFrames.empty() && canPrefetchFrame())
+		prefetchFrame();
+
+	if (!_prefetchedFrames.empty()) {
+		_shownFrame = _prefetchedFrames.pop();
+
+		if (_shownFrame->dirtyPalette) {
+			memcpy(_prefetchPalette, _shownFrame->palette, sizeof(_prefetchPalette));
+			_palette = _prefetchPalette;
+			_dirtyPalette = true;
+		}
+
+		return _shownFrame->hasSurface ? &_shownFrame->surface : 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -210,6 +257,10 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames decoded ahead have to be decoded again in the other direction
+	if (reverse && !_prefetchedFrames.empty() && !seekToFrame(_prefetchedFrames.front()->curFrame + 1))
+		return false;
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -230,6 +281,9 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (!_prefetchedFrames.empty())
+		return _prefetchedFrames.front()->curFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -271,13 +325,20 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate)
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime;
 
-	if (_nextVideoTrack->isReversed()) {
+	if (!_prefetchedFrames.empty())
+		nextFrameStartTime = _prefetchedFrames.front()->nextFrameStartTime;
+	else if (_nextVideoTrack)
+		nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	else
+		return 0;
+
+	if (_prefetchedFrames.empty() && _nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -296,8 +357,12 @@ bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool endReached;
+		if (track->getTrackType() == Track::kTrackTypeVideo)
+			endReached = videoTrackEnded((const VideoTrack *)track);
+		else
+			endReached = track->endOfTrack();
+
 		if (!endReached)
 			return false;
 	}
@@ -320,6 +385,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	flushPrefetchedFrames();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -354,6 +421,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	flushPrefetchedFrames();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -420,6 +489,11 @@ void VideoDecoder::stop() {
 	if (!isPlaying())
 		return;
 
+	// Frames decoded ahead would be skipped when starting again, so go back
+	// to the first one not shown yet if possible
+	if (!_prefetchedFrames.empty() && !(isSeekable() && seekToFrame(_prefetchedFrames.front()->curFrame + 1)))
+		flushPrefetchedFrames();
+
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
@@ -919,17 +993,104 @@ bool VideoDecoder::hasFramesLeft() const {
 		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
 			continue;
 
-		const VideoTrack *track = (const VideoTrack *)*it;
-
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
-		if (!endReached)
+		if (!videoTrackEnded((const VideoTrack *)*it))
 			return true;
 	}
 
 	return false;
 }
 
+bool VideoDecoder::videoTrackEnded(const VideoTrack *track) const {
+	// Frames decoded ahead of time have not been shown yet. There is only
+	// one video track in that case.
+	if (!_prefetchedFrames.empty())
+		return isPlaying() && _endTimeSet && _prefetchedFrames.front()->nextFrameStartTime >= (uint)_endTime.msecs();
+
+	bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
+	return track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+}
+
+bool VideoDecoder::canPrefetchFrame() const {
+	if ((uint)_prefetchedFrames.size() >= _prefetchFrameCount || !isPlaying() || !_nextVideoTrack)
+		return false;
+
+	if (_nextVideoTrack->isReversed() || _nextVideoTrack->endOfTrack())
+		return false;
+
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && *it != _nextVideoTrack)
+			return false;
+
+	// Frames after the end time are never shown
+	return !_endTimeSet || _nextVideoTrack->getNextFrameStartTime() < (uint)_endTime.msecs();
+}
+
+void VideoDecoder::prefetchFrame() {
+	PrefetchedFrame *frame;
+	if (_freeFrames.empty()) {
+		frame = new PrefetchedFrame();
+	} else {
+		frame = _freeFrames.back();
+		_freeFrames.pop_back();
+	}
+
+	// The palette of the track changes while decoding ahead
+	if (_palette && _palette != _prefetchPalette) {
+		memcpy(_prefetchPalette, _palette, sizeof(_prefetchPalette));
+		_palette = _prefetchPalette;
+	}
+
+	frame->curFrame = _nextVideoTrack->getCurFrame();
+	frame->nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+
+	_canSetDither = false;
+	readNextPacket();
+
+	const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+	frame->hasSurface = surface != 0;
+
+	if (surface) {
+		if (frame->surface.w != surface->w || frame->surface.h != surface->h || frame->surface.format != surface->format) {
+			frame->surface.free();
+			frame->surface.create(surface->w, surface->h, surface->format);
+		}
+
+		frame->surface.copyRectToSurface(surface->getPixels(), surface->pitch, 0, 0, surface->w, surface->h);
+	}
+
+	frame->dirtyPalette = _nextVideoTrack->hasDirtyPalette();
+	if (frame->dirtyPalette)
+		memcpy(frame->palette, _nextVideoTrack->getPalette(), sizeof(frame->palette));
+
+	_prefetchedFrames.push(frame);
+	findNextVideoTrack();
+}
+
+void VideoDecoder::decodeAhead() {
+	while (canPrefetchFrame()) {
+		// Only decode another frame if it is likely to be done before the
+		// next one is due, judging by how long the previous one took
+		if (getTimeToNextFrame() <= _prefetchDecodeTime)
+			break;
+
+		const uint32 startTime = g_system->getMillis();
+		prefetchFrame();
+		_prefetchDecodeTime = g_system->getMillis() - startTime;
+	}
+}
+
+void VideoDecoder::flushPrefetchedFrames() {
+	while (!_prefetchedFrames.empty())
+		_freeFrames.push_back(_prefetchedFrames.pop());
+}
+
+void VideoDecoder::recycleShownFrame() {
+	if (_shownFrame) {
+		_freeFrames.push_back(_shownFrame);
+		_shownFrame = 0;
+	}
+}
+
 bool VideoDecoder::hasAudio() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
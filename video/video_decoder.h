@@ -26,6 +26,7 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/queue.h"
 #include "common/rational.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
@@ -52,7 +53,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -338,6 +339,36 @@ public:
 	 */
 	bool needsUpdate() const;
 
+	/**
+	 * Set how many frames may be decoded ahead of time.
+	 *
+	 * Frames are decoded ahead by decodeAhead(), which the engine calls
+	 * while waiting for the next frame to be due, and are later returned in
+	 * order by decodeNextFrame(). This spreads out the time needed for
+	 * expensive frames, such as key frames, over the time otherwise spent
+	 * waiting.
+	 *
+	 * This is only done for videos with a single video track which are played
+	 * forward. Seeking and rewinding drop the frames decoded ahead, and
+	 * stopping seeks back to the first frame not shown yet.
+	 *
+	 * The default is taken from the "video_prefetch_frames" setting.
+	 *
+	 * @param count The maximum number of frames to decode ahead, 0 to disable it
+	 */
+	void setPrefetchFrameCount(uint count) { _prefetchFrameCount = count; }
+
+	/**
+	 * Decode frames ahead of time, up to the count set by
+	 * setPrefetchFrameCount(), and only as long as that doesn't delay the
+	 * next frame.
+	 *
+	 * Call this after showing the frame returned by decodeNextFrame(), e.g.
+	 * instead of part of the delay until needsUpdate() returns true. It does
+	 * nothing if decoding ahead is disabled.
+	 */
+	void decodeAhead();
+
 	/**
 	 * Decode the next frame into a surface and return the latter.
 	 *
@@ -946,6 +977,15 @@ private:
 	// Enforcement of not being able to set dither
 	bool _canSetDither;
 
+	// Frames decoded ahead of time
+	struct PrefetchedFrame;
+	uint _prefetchFrameCount;
+	Common::Queue<PrefetchedFrame *> _prefetchedFrames;
+	Common::Array<PrefetchedFrame *> _freeFrames;
+	PrefetchedFrame *_shownFrame;
+	uint32 _prefetchDecodeTime;
+	byte _prefetchPalette[256 * 3];
+
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 
@@ -955,6 +995,11 @@ private:
 	void startAudioLimit(const Audio::Timestamp &limit);
 	bool hasFramesLeft() const;
 	bool hasAudio() const;
+	bool videoTrackEnded(const VideoTrack *track) const;
+	bool canPrefetchFrame() const;
+	void prefetchFrame();
+	void flushPrefetchedFrames();
+	void recycleShownFrame();
 
 	int32 _startTime;
 	uint32 _pauseLevel;